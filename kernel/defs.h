@@ -4,6 +4,8 @@ struct file;
 struct inode;
 struct pipe;
 struct proc;
+struct rbnode;
+struct rbtree;
 struct spinlock;
 struct sleeplock;
 struct stat;
@@ -61,8 +63,10 @@ void            ramdiskrw(struct buf*);
 
 // kalloc.c
 void*           kalloc(void);
+void*           kallocn(uint64);
 void            kfree(void *);
 void            kinit(void);
+int             kfreepages(void);
 void            incref(void *pa);
 int             decref(void *pa);
 int             getref(void *pa);
@@ -89,7 +93,6 @@ int             cpuid(void);
 void            exit(int);
 int             fork(void);
 int             growproc(int);
-void            proc_mapstacks(pagetable_t);
 pagetable_t     proc_pagetable(struct proc *);
 void            proc_freepagetable(pagetable_t, uint64);
 int             kill(int);
@@ -109,6 +112,36 @@ void            yield(void);
 int             either_copyout(int user_dst, uint64 dst, void *src, uint64 len);
 int             either_copyin(void *dst, int user_src, uint64 src, uint64 len);
 void            procdump(void);
+void            setstate(struct proc*, int);
+struct proc*    findproc(int);
+int             procstat(uint64, int);
+void            notemaxrss(struct proc*);
+void            rssadd(pagetable_t, int);
+int             waitpid(int, uint64, int, uint64);
+
+// sched.c
+void            runqinit(void);
+struct proc*    runqget(void);
+void            runqrequeue(struct proc*);
+void            runqdone(struct proc*, uint64);
+void            runqstart(struct proc*);
+int             schedlat(uint64);
+void            setrunnable(struct proc*);
+int             setcurrency(struct proc*, int);
+int             curralloc(struct proc*, int);
+void            ticketlend(struct proc*, struct proc*, int);
+void            ticketreturn(struct proc*);
+void            runqidle(void);
+int             schedtick(struct proc*);
+int             needresched(void);
+int             schedprio(void);
+int             schedid(struct proc*);
+int             setsched(int);
+
+// sched_deadline.c
+int             dlset(struct proc*, int, int, int);
+void            dlleave(struct proc*);
+uint            dldone(struct proc*);
 
 // swtch.S
 void            swtch(struct context*, struct context*);
@@ -121,6 +154,10 @@ void            release(struct spinlock*);
 void            push_off(void);
 void            pop_off(void);
 
+// rbtree.c
+void            rbinsert(struct rbtree*, struct rbnode*, int (*)(struct rbnode*, struct rbnode*));
+void            rberase(struct rbtree*, struct rbnode*);
+
 // sleeplock.c
 void            acquiresleep(struct sleeplock*);
 void            releasesleep(struct sleeplock*);
@@ -144,12 +181,18 @@ int             fetchstr(uint64, char*, int);
 int             fetchaddr(uint64, uint64*);
 void            syscall();
 
+// trace.c
+void            trace(int, int, int, int);
+int             settrace(int);
+int             traceread(uint64);
+
 // trap.c
 extern uint     ticks;
 void            trapinit(void);
 void            trapinithart(void);
 extern struct spinlock tickslock;
 void            usertrapret(void);
+void            ipi(int);
 
 // uart.c
 void            uartinit(void);
@@ -173,6 +216,7 @@ void            uvmunmap(pagetable_t, uint64, uint64, int);
 void            uvmclear(pagetable_t, uint64);
 pte_t *         walk(pagetable_t, uint64, int);
 uint64          walkaddr(pagetable_t, uint64);
+uint64          uvmrss(pagetable_t);
 int             copyout(pagetable_t, uint64, char *, uint64);
 int             copyin(pagetable_t, char *, uint64, uint64);
 int             copyinstr(pagetable_t, char *, uint64, uint64);
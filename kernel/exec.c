@@ -24,7 +24,7 @@ exec(char *path, char **argv)
 {
   char *s, *last;
   int i, off;
-  uint64 argc, sz = 0, sp, ustack[MAXARG], stackbase;
+  uint64 argc, sz = 0, sp, ustack[MAXARG], stackbase, rss;
   struct elfhdr elf;
   struct inode *ip;
   struct proghdr ph;
@@ -120,10 +120,18 @@ exec(char *path, char **argv)
       last = s+1;
   safestrcpy(p->name, last, sizeof(p->name));
     
-  // Commit to the user image.
+  // Commit to the user image. Switch page tables under
+  // p->lock, so that procstat() sees the new image's size and
+  // resident set together. The new page table was built
+  // without counting its pages; count them now.
+  notemaxrss(p);
+  rss = uvmrss(pagetable);
+  acquire(&p->lock);
   oldpagetable = p->pagetable;
   p->pagetable = pagetable;
   p->sz = sz;
+  p->rss = rss;
+  release(&p->lock);
   p->trapframe->epc = elf.entry;  // initial program counter = main
   p->trapframe->sp = sp; // initial stack pointer
   proc_freepagetable(oldpagetable, oldsz);
@@ -0,0 +1,6 @@
+// Per-CPU idle time, as reported by idlestat().
+struct idlestat {
+  uint64 now;                  // r_time() when the report was made
+  uint64 online[NCPU];         // r_time() when each CPU started, 0 if never
+  uint64 idle[NCPU];           // Cycles each CPU has spent idle
+};
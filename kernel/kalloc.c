@@ -250,18 +250,33 @@ kfree(void *pa)
     return;
   }
 
-  // Fill with junk to catch dangling refs.
-  memset(pa, 1, PGSIZE);
-
   // Get the order of this block
   int index = pa2index(pa);
   int order = kmem.order_map[index];
+
+  // Fill with junk to catch dangling refs.
+  memset(pa, 1, PAGE_SIZE << order);
   
   acquire(&kmem.lock);
   buddy_free(pa, order);
   release(&kmem.lock);
 }
 
+// Return the number of free pages.
+int
+kfreepages(void)
+{
+  struct run *r;
+  int i, n = 0;
+
+  acquire(&kmem.lock);
+  for(i = 0; i <= MAX_ORDER; i++)
+    for(r = kmem.freelist[i]; r; r = r->next)
+      n += 1 << i;
+  release(&kmem.lock);
+  return n;
+}
+
 // Allocate one 4096-byte page of physical memory.
 // Returns a pointer that the kernel can use.
 // Returns 0 if the memory cannot be allocated.
@@ -284,3 +299,28 @@ kalloc(void)
   }
   return pa;
 }
+
+// Allocate a physically contiguous block of at least size
+// bytes, a power of two pages, for kernel buffers bigger than
+// a page. Free it with kfree(). The block is never mapped into
+// user space, so it is not reference counted: kfree() only
+// frees pages whose count is 0.
+// Returns 0 if the memory cannot be allocated.
+void *
+kallocn(uint64 size)
+{
+  void *pa;
+  int order;
+
+  if(size > (PAGE_SIZE << MAX_ORDER))
+    return 0;
+  order = get_order(size);
+
+  acquire(&kmem.lock);
+  pa = buddy_alloc(order);
+  release(&kmem.lock);
+
+  if(pa)
+    memset((char*)pa, 5, PAGE_SIZE << order); // fill with junk
+  return pa;
+}
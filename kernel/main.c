@@ -19,6 +19,7 @@ void main()
         kvminit();              // 初始化内核页表并配置好内核的虚拟地址空间到物理地址空间的映射
         kvminithart();          // 启用分页
         procinit();             // 初始化进程表
+        runqinit();             // 初始化每个 CPU 的运行队列
         trapinit();             // 设置陷阱处理程序入口
         trapinithart();         // 为当前 CPU 配置陷阱处理寄存器
         plicinit();             // 初始化 RISC-V 平台级中断控制器（PLIC），管理外设中断
@@ -1,5 +1,8 @@
-#define NPROC        64  // maximum number of processes
+#define NPROC       256  // hard cap on process slots; sizes per-CPU run queue arrays
+#define PROCPAGES    16  // free pages per process slot when sizing the table
 #define NCPU          8  // maximum number of CPUs
+#define NCURRENCY    16  // maximum number of LOTTERY ticket currencies
+#define QUANTUM  1000000 // timer cycles per clock tick, about 0.1s
 #define NOFILE       16  // open files per process
 #define NFILE       100  // open files per system
 #define NINODE       50  // maximum number of active i-nodes
@@ -17,6 +17,10 @@ struct pipe {
   uint nwrite;    // number of bytes written
   int readopen;   // read fd is still open
   int writeopen;  // write fd is still open
+  struct proc *reader;  // last process to read, for ticketlend()
+  struct proc *writer;  // last process to write
+  int readerpid;
+  int writerpid;
 };
 
 int
@@ -34,6 +38,8 @@ pipealloc(struct file **f0, struct file **f1)
   pi->writeopen = 1;
   pi->nwrite = 0;
   pi->nread = 0;
+  pi->reader = pi->writer = 0;
+  pi->readerpid = pi->writerpid = 0;
   initlock(&pi->lock, "pipe");
   (*f0)->type = FD_PIPE;
   (*f0)->readable = 1;
@@ -80,6 +86,8 @@ pipewrite(struct pipe *pi, uint64 addr, int n)
   struct proc *pr = myproc();
 
   acquire(&pi->lock);
+  pi->writer = pr;
+  pi->writerpid = pr->pid;
   while(i < n){
     if(pi->readopen == 0 || killed(pr)){
       release(&pi->lock);
@@ -87,7 +95,10 @@ pipewrite(struct pipe *pi, uint64 addr, int n)
     }
     if(pi->nwrite == pi->nread + PIPESIZE){ //DOC: pipewrite-full
       wakeup(&pi->nread);
+      // lend our tickets to the reader we are waiting for.
+      ticketlend(pr, pi->reader, pi->readerpid);
       sleep(&pi->nwrite, &pi->lock);
+      ticketreturn(pr);
     } else {
       char ch;
       if(copyin(pr->pagetable, &ch, addr + i, 1) == -1)
@@ -110,12 +121,17 @@ piperead(struct pipe *pi, uint64 addr, int n)
   char ch;
 
   acquire(&pi->lock);
+  pi->reader = pr;
+  pi->readerpid = pr->pid;
   while(pi->nread == pi->nwrite && pi->writeopen){  //DOC: pipe-empty
     if(killed(pr)){
       release(&pi->lock);
       return -1;
     }
+    // lend our tickets to the writer we are waiting for.
+    ticketlend(pr, pi->writer, pi->writerpid);
     sleep(&pi->nread, &pi->lock); //DOC: piperead-sleep
+    ticketreturn(pr);
   }
   for(i = 0; i < n; i++){  //DOC: piperead-copy
     if(pi->nread == pi->nwrite)
@@ -0,0 +1,22 @@
+// Scheduling policies, for setsched().
+#define SCHED_DEFAULT   0  // Round robin
+#define SCHED_PRIORITY  1  // Lowest priority value first
+#define SCHED_FCFS      2  // Oldest process first, not preempted
+#define SCHED_LOTTERY   3  // Proportional share, by lottery
+#define SCHED_SML       4  // Static multilevel queues
+#define SCHED_STRIDE    5  // Proportional share, by stride
+#define SCHED_FAIR      6  // Weighted fair share by vruntime
+#define SCHED_MLFQ      7  // Multilevel feedback queue
+#define SCHED_SRTF      8  // Shortest predicted burst left first
+#define NSCHED          9  // Number of policies
+
+// Scheduling classes, for setclass(), highest first. A run
+// queue runs the processes of the first class that has any;
+// the normal class is ordered by the policy. A process is in
+// the deadline class through sched_deadline().
+#define CLASS_DEADLINE  0  // Earliest deadline first
+#define CLASS_RT        1  // Fixed priority, 1 (highest) to NRTPRIO
+#define CLASS_NORMAL    2  // The current policy
+#define CLASS_IDLE      3  // Only when nothing else is runnable
+#define NCLASS          4  // Number of classes
+#define NRTPRIO        20  // Lowest real-time priority
@@ -5,26 +5,59 @@
 #include "spinlock.h"
 #include "proc.h"
 #include "defs.h"
+#include "policy.h"
+#include "procstat.h"
+#include "rusage.h"
+#include "trace.h"
 
 struct cpu cpus[NCPU];
 
-struct proc proc[NPROC];
+// Process slots are created on demand, up to maxproc, and are
+// never freed: a proc struct carved out of a slab page and a
+// kernel stack mapped at KSTACK(slot). Unused slots are kept on
+// freeprocs, so allocating one doesn't depend on the table size.
+// nslot only grows, and procs[i] is set before nslot covers i,
+// so procs[0..nslot) can be walked without proc_lock.
+struct proc *procs[NPROC];
+int nslot;
+uint kstackgen;                // Bumped whenever a kernel stack is mapped
+
+static struct spinlock proc_lock;  // Protects what follows
+static int maxproc;            // Slot limit, set by procinit()
+static struct proc *freeprocs; // Unused slots
+static char *slab;             // Unused part of the current slab page
+static int slabfree;           // Bytes left in it
 
 struct proc *initproc;
 
 int nextpid = 1;
 struct spinlock pid_lock;
 
+// Processes with a pid, hashed by pid, so that the pid-based
+// system calls don't scan proc[]. Protected by pid_lock.
+#define NPIDHASH (NPROC / 4)
+static struct proc *pidhash[NPIDHASH];
+
 extern void forkret(void);
 static void freeproc(struct proc *p);
 
 extern char trampoline[]; // trampoline.S
+extern pagetable_t kernel_pagetable; // vm.c
+
+// Sleeping processes hang on a hash table of queues keyed by
+// channel, so wakeup() only looks at processes whose channel
+// hashes like its own. A process stays queued until wakeup()
+// makes it RUNNABLE, or, if kill() woke it, until it returns
+// from sleep(). Locks are taken in the order: the sleep lock,
+// then the queue's lock, then p->lock.
+#define NSLEEPQ 64
+
+struct sleepq {
+  struct spinlock lock;
+  struct proc *head;
+};
 
-// Scheduling statistics update function
-void updatestatistics(void);
-int random(int max);
-int totalTickets(void);
-struct proc* findReadyProcess(int *index1, int *index2, int *index3, uint *priority);
+static struct sleepq sleepqs[NSLEEPQ];
 
 // helps ensure that wakeups of wait()ing
 // parents are not lost. helps obey the
@@ -32,36 +65,62 @@ struct proc* findReadyProcess(int *index1, int *index2, int *index3, uint *prior
 // must be acquired before any p->lock.
 struct spinlock wait_lock;
 
-// Allocate a page for each process's kernel stack.
-// Map it high in memory, followed by an invalid
-// guard page.
-void proc_mapstacks(pagetable_t kpgtbl)
-{
-    struct proc *p;
-
-    for (p = proc; p < &proc[NPROC]; p++) {
-        char *pa = kalloc();
-        if (pa == 0)
-            panic("kalloc");
-        // 计算每个进程的内核栈的虚拟地址
-        uint64 va = KSTACK((int)(p - proc));
-        kvmmap(kpgtbl, va, (uint64)pa, PGSIZE, PTE_R | PTE_W);
-    }
-}
-
 // initialize the proc table.
 void
 procinit(void)
 {
-  struct proc *p;
+  int i;
   
   initlock(&pid_lock, "nextpid");
   initlock(&wait_lock, "wait_lock");
-  for(p = proc; p < &proc[NPROC]; p++) {
-      initlock(&p->lock, "proc");
-      p->state = UNUSED;
-      p->kstack = KSTACK((int) (p - proc));
+  initlock(&proc_lock, "proctab");
+  for(i = 0; i < NSLEEPQ; i++)
+    initlock(&sleepqs[i].lock, "sleepq");
+
+  // leave each process PROCPAGES pages of the free memory.
+  maxproc = kfreepages() / PROCPAGES;
+  if(maxproc > NPROC)
+    maxproc = NPROC;
+}
+
+// Create a new process slot.
+// Caller must hold proc_lock.
+static struct proc*
+newslot(void)
+{
+  struct proc *p;
+  char *stack;
+
+  if(nslot >= maxproc)
+    return 0;
+  if(slabfree < sizeof(struct proc)){
+    if((slab = kalloc()) == 0)
+      return 0;
+    memset(slab, 0, PGSIZE);
+    slabfree = PGSIZE;
   }
+  if((stack = kalloc()) == 0)
+    return 0;
+  p = (struct proc*)slab;
+  p->slot = nslot;
+  p->kstack = KSTACK(nslot);
+  if(mappages(kernel_pagetable, p->kstack, PGSIZE, (uint64)stack, PTE_R | PTE_W) != 0){
+    kfree(stack);
+    return 0;
+  }
+  slab += sizeof(struct proc);
+  slabfree -= sizeof(struct proc);
+  initlock(&p->lock, "proc");
+  p->state = UNUSED;
+
+  // other harts flush their TLBs before running p;
+  // see scheduler().
+  sfence_vma();
+  kstackgen++;
+  procs[nslot] = p;
+  __sync_synchronize();
+  nslot++;
+  return p;
 }
 
 // Must be called with interrupts disabled,
@@ -108,6 +167,61 @@ allocpid()
   return pid;
 }
 
+// Caller must hold p->lock.
+static void
+pidinsert(struct proc *p)
+{
+  struct proc **pp = &pidhash[p->pid % NPIDHASH];
+
+  acquire(&pid_lock);
+  p->pidnext = *pp;
+  *pp = p;
+  release(&pid_lock);
+}
+
+// Caller must hold p->lock.
+static void
+pidremove(struct proc *p)
+{
+  struct proc **pp;
+
+  acquire(&pid_lock);
+  for(pp = &pidhash[p->pid % NPIDHASH]; *pp; pp = &(*pp)->pidnext){
+    if(*pp == p){
+      *pp = p->pidnext;
+      break;
+    }
+  }
+  p->pidnext = 0;
+  release(&pid_lock);
+}
+
+// Return the process with the given pid with its lock held,
+// or 0 if there is none. pid_lock is dropped before taking
+// p->lock, so p may have exited and its slot been reused in
+// between; the check of p->pid under p->lock catches that.
+struct proc*
+findproc(int pid)
+{
+  struct proc *p;
+
+  if(pid <= 0)
+    return 0;
+  acquire(&pid_lock);
+  for(p = pidhash[pid % NPIDHASH]; p; p = p->pidnext)
+    if(p->pid == pid)
+      break;
+  release(&pid_lock);
+  if(p == 0)
+    return 0;
+  acquire(&p->lock);
+  if(p->pid != pid){
+    release(&p->lock);
+    return 0;
+  }
+  return p;
+}
+
 // Look in the process table for an UNUSED proc.
 // If found, initialize state required to run in the kernel,
 // and return with p->lock held.
@@ -117,34 +231,56 @@ allocproc(void)
 {
   struct proc *p;
 
-  for(p = proc; p < &proc[NPROC]; p++) {
-    acquire(&p->lock);
-    if(p->state == UNUSED) {
-      goto found;
-    } else {
-      release(&p->lock);
-    }
-  }
-  return 0;
+  acquire(&proc_lock);
+  if((p = freeprocs) != 0)
+    freeprocs = p->nextfree;
+  else
+    p = newslot();
+  release(&proc_lock);
+  if(p == 0)
+    return 0;
 
-found:
+  acquire(&p->lock);
   p->pid = allocpid();
+  pidinsert(p);
   p->state = USED;
 
   // Initialize scheduling fields
-  #ifdef PRIORITY
-    p->priority = 10;
-  #else
-  #ifdef SML
-    p->priority = 2;
-  #endif
-  #endif
+  p->priority = schedprio();
+  p->policy = 0;
   
   p->ctime = ticks;
   p->retime = 0;
   p->rutime = 0;
   p->stime = 0;
+  p->stamp = r_time();
   p->tickets = DEFAULT_TICKETS;
+  p->currency = 0;
+  p->curactive = 0;
+  p->used = 0;
+  p->remain = 0;
+  p->vruntime = 0;
+  p->mlfqlevel = 0;
+  p->mlfqticks = 0;
+  p->mlfqepoch = 0;
+  p->predict = 0;
+  p->burstran = 0;
+  p->srtfticks = 0;
+  p->dlperiod = 0;
+  p->dlbw = 0;
+  p->dlmisses = 0;
+  p->class = CLASS_NORMAL;
+  p->rtprio = 0;
+  p->idleticks = 0;
+  p->borrowed = 0;
+  p->lendee = 0;
+  p->woken = 0;
+  p->cpu = 0;
+  p->pgfaults = 0;
+  p->rss = 0;
+  p->maxrss = 0;
+  p->nvcsw = 0;
+  p->nivcsw = 0;
 
   // Allocate a trapframe page.
   if((p->trapframe = (struct trapframe *)kalloc()) == 0){
@@ -183,6 +319,9 @@ freeproc(struct proc *p)
     proc_freepagetable(p->pagetable, p->sz);
   p->pagetable = 0;
   p->sz = 0;
+  setcurrency(p, 0);
+  if(p->pid)
+    pidremove(p);
   p->pid = 0;
   p->parent = 0;
   p->name[0] = 0;
@@ -190,6 +329,11 @@ freeproc(struct proc *p)
   p->killed = 0;
   p->xstate = 0;
   p->state = UNUSED;
+
+  acquire(&proc_lock);
+  p->nextfree = freeprocs;
+  freeprocs = p;
+  release(&proc_lock);
 }
 
 // Create a user page table for a given process, with no user memory,
@@ -262,6 +406,7 @@ userinit(void)
   // and data into it.
   uvmfirst(p->pagetable, initcode, sizeof(initcode));
   p->sz = PGSIZE;
+  p->rss = 1;
 
   // prepare for the very first "return" from kernel to user.
   p->trapframe->epc = 0;      // user program counter
@@ -272,7 +417,7 @@ userinit(void)
   safestrcpy(p->name, "initcode", sizeof(p->name));
   p->cwd = namei("/");
 
-  p->state = RUNNABLE;
+  setrunnable(p);
 
   release(&p->lock);
 }
@@ -291,12 +436,38 @@ growproc(int n)
       return -1;
     }
   } else if(n < 0){
+    notemaxrss(p);
     sz = uvmdealloc(p->pagetable, sz, sz + n);
   }
   p->sz = sz;
   return 0;
 }
 
+// Add p to the children or zombies list at *head.
+// Caller must hold wait_lock.
+static void
+sibpush(struct proc **head, struct proc *p)
+{
+  p->sibprev = 0;
+  p->sibnext = *head;
+  if(*head)
+    (*head)->sibprev = p;
+  *head = p;
+}
+
+// Caller must hold wait_lock.
+static void
+sibremove(struct proc **head, struct proc *p)
+{
+  if(p->sibprev)
+    p->sibprev->sibnext = p->sibnext;
+  else
+    *head = p->sibnext;
+  if(p->sibnext)
+    p->sibnext->sibprev = p->sibprev;
+  p->sibnext = p->sibprev = 0;
+}
+
 // Create a new process, copying the parent.
 // Sets up child kernel stack to return as if from fork() system call.
 int
@@ -318,13 +489,18 @@ fork(void)
     return -1;
   }
   np->sz = p->sz;
+  np->rss = p->rss;
 
   // copy saved user registers.
   *(np->trapframe) = *(p->trapframe);
 
   // Copy scheduling fields from parent
   np->tickets = p->tickets; // used in LOTTERY
-  np->priority = p->priority; // used in PRIORITY and SML
+  setcurrency(np, p->currency);
+  np->priority = p->priority; // used in PRIORITY, SML and FAIR
+  np->vruntime = p->vruntime; // used in FAIR
+  np->class = p->class;
+  np->rtprio = p->rtprio;
 
   // Cause fork to return 0 in the child.
   np->trapframe->a0 = 0;
@@ -343,10 +519,13 @@ fork(void)
 
   acquire(&wait_lock);
   np->parent = p;
+  sibpush(&p->children, np);
   release(&wait_lock);
 
   acquire(&np->lock);
-  np->state = RUNNABLE;
+  np->cpu = p->cpu;
+  TRACE(TRACE_FORK, pid, USED, RUNNABLE);
+  setrunnable(np);
   release(&np->lock);
 
   return pid;
@@ -358,13 +537,22 @@ void
 reparent(struct proc *p)
 {
   struct proc *pp;
+  int moved = 0;
 
-  for(pp = proc; pp < &proc[NPROC]; pp++){
-    if(pp->parent == p){
-      pp->parent = initproc;
-      wakeup(initproc);
-    }
+  while((pp = p->children) != 0){
+    sibremove(&p->children, pp);
+    pp->parent = initproc;
+    sibpush(&initproc->children, pp);
+    moved = 1;
   }
+  while((pp = p->zombies) != 0){
+    sibremove(&p->zombies, pp);
+    pp->parent = initproc;
+    sibpush(&initproc->zombies, pp);
+    moved = 1;
+  }
+  if(moved)
+    wakeup(initproc);
 }
 
 // Exit the current process.  Does not return.
@@ -378,6 +566,8 @@ exit(int status)
   if(p == initproc)
     panic("init exiting");
 
+  notemaxrss(p);
+
   // Close all open files.
   for(int fd = 0; fd < NOFILE; fd++){
     if(p->ofile[fd]){
@@ -397,13 +587,19 @@ exit(int status)
   // Give any children to init.
   reparent(p);
 
+  // Let the parent's wait() find p.
+  sibremove(&p->parent->children, p);
+  sibpush(&p->parent->zombies, p);
+
   // Parent might be sleeping in wait().
   wakeup(p->parent);
   
   acquire(&p->lock);
 
   p->xstate = status;
-  p->state = ZOMBIE;
+  dlleave(p);
+  TRACE(TRACE_EXIT, p->pid, RUNNING, ZOMBIE);
+  setstate(p, ZOMBIE);
 
   release(&wait_lock);
 
@@ -417,50 +613,152 @@ exit(int status)
 int
 wait(uint64 addr)
 {
-  struct proc *pp;
-  int havekids, pid;
+  return waitpid(-1, addr, 0, 0);
+}
+
+// Note p's resident set size as a candidate for its peak. A
+// process's resident set only shrinks when it frees memory,
+// execs or exits, so calling this first in each is enough.
+void
+notemaxrss(struct proc *p)
+{
+  if(p->rss > p->maxrss)
+    p->maxrss = p->rss;
+}
+
+// n user pages were mapped in pagetable, or unmapped if n is
+// negative. Count them in the current process's resident set
+// if pagetable is its own; fork() and exec() set the count of
+// the page tables they build.
+void
+rssadd(pagetable_t pagetable, int n)
+{
+  struct proc *p = myproc();
+
+  if(p && p->pagetable == pagetable)
+    p->rss += n;
+}
+
+// Where reap() copies what it learns about the child it reaps,
+// in the caller's memory. Any address may be 0.
+struct reapto {
+  uint64 status;               // int exit status
+  uint64 ru;                   // struct rusage
+  uint64 retime;               // uint64 times, for wait2()
+  uint64 rutime;
+  uint64 stime;
+};
+
+// Copy n bytes from src to p's user address dst, unless dst
+// is 0. Returns -1 if dst is bad.
+static int
+copyopt(struct proc *p, uint64 dst, void *src, uint64 n)
+{
+  if(dst == 0)
+    return 0;
+  return copyout(p->pagetable, dst, (char *)src, n);
+}
+
+// Wait for child pid, or any child if pid is -1, to exit, copy
+// its exit status and what it used to the addresses in *to,
+// and return its pid. With WNOHANG in options, return 0
+// instead of waiting if the child hasn't exited yet. Return -1
+// if there is no such child, or, leaving the child unreaped,
+// if an address is bad.
+static int
+reap(int pid, int options, struct reapto *to)
+{
+  struct proc *pp, *busy;
+  struct rusage r;
   struct proc *p = myproc();
 
   acquire(&wait_lock);
 
   for(;;){
-    // Scan through table looking for exited children.
-    havekids = 0;
-    for(pp = proc; pp < &proc[NPROC]; pp++){
-      if(pp->parent == p){
-        // make sure the child isn't still in exit() or swtch().
-        acquire(&pp->lock);
-
-        havekids = 1;
-        if(pp->state == ZOMBIE){
-          // Found one.
-          pid = pp->pid;
-          if(addr != 0 && copyout(p->pagetable, addr, (char *)&pp->xstate,
-                                  sizeof(pp->xstate)) < 0) {
-            release(&pp->lock);
-            release(&wait_lock);
-            return -1;
-          }
-          freeproc(pp);
-          release(&pp->lock);
-          release(&wait_lock);
-          return pid;
-        }
+    // An exited child to reap, or a live one to wait for.
+    if(pid == -1){
+      pp = p->zombies;
+      busy = p->children;
+    } else {
+      for(pp = p->zombies; pp && pp->pid != pid; pp = pp->sibnext)
+        ;
+      for(busy = p->children; busy && busy->pid != pid; busy = busy->sibnext)
+        ;
+    }
+
+    if(pp){
+      // make sure the child isn't still in exit() or swtch().
+      acquire(&pp->lock);
+      pid = pp->pid;
+      r.retime = pp->retime;
+      r.rutime = pp->rutime;
+      r.stime = pp->stime;
+      r.nvcsw = pp->nvcsw;
+      r.nivcsw = pp->nivcsw;
+      r.pgfaults = pp->pgfaults;
+      r.maxrss = pp->maxrss;
+      if(copyopt(p, to->status, &pp->xstate, sizeof(pp->xstate)) < 0 ||
+         copyopt(p, to->ru, &r, sizeof(r)) < 0 ||
+         copyopt(p, to->retime, &r.retime, sizeof(r.retime)) < 0 ||
+         copyopt(p, to->rutime, &r.rutime, sizeof(r.rutime)) < 0 ||
+         copyopt(p, to->stime, &r.stime, sizeof(r.stime)) < 0){
         release(&pp->lock);
+        release(&wait_lock);
+        return -1;
       }
+      sibremove(&p->zombies, pp);
+      freeproc(pp);
+      release(&pp->lock);
+      release(&wait_lock);
+      return pid;
     }
 
-    // No point waiting if we don't have any children.
-    if(!havekids || killed(p)){
+    // No point waiting if we don't have any such children.
+    if(busy == 0 || killed(p)){
       release(&wait_lock);
       return -1;
     }
+    if(options & WNOHANG){
+      release(&wait_lock);
+      return 0;
+    }
     
-    // Wait for a child to exit.
+    // Wait for a child to exit, lending it our tickets.
+    // The child can't be freed while we hold wait_lock
+    // or are asleep, since only we can reap it.
+    ticketlend(p, busy, busy->pid);
     sleep(p, &wait_lock);  //DOC: wait-sleep
+    ticketreturn(p);
   }
 }
 
+// Wait for child pid, or any child if pid is -1, to exit, copy
+// its exit status to addr and what it used to the struct
+// rusage at ru (either may be 0), and return its pid. With
+// WNOHANG in options, return 0 instead of waiting if the child
+// hasn't exited yet. Return -1 if there is no such child.
+int
+waitpid(int pid, uint64 addr, int options, uint64 ru)
+{
+  struct reapto to = { .status = addr, .ru = ru };
+
+  return reap(pid, options, &to);
+}
+
+// wait() for any child, copying its RUNNABLE, RUNNING and
+// SLEEPING times to the given addresses (any may be 0).
+int
+wait2(uint64 retime_addr, uint64 rutime_addr, uint64 stime_addr)
+{
+  struct reapto to = {
+    .retime = retime_addr,
+    .rutime = rutime_addr,
+    .stime = stime_addr,
+  };
+
+  return reap(-1, 0, &to);
+}
+
 // Per-CPU process scheduler.
 // Each CPU calls scheduler() after setting itself up.
 // Scheduler never returns.  It loops, doing:
@@ -471,137 +769,55 @@ wait(uint64 addr)
 void
 scheduler(void)
 {
-  struct proc *p = 0;
+  struct proc *p;
   struct cpu *c = mycpu();
 
   c->proc = 0;
+  c->online = r_time();
+  for(;;){
+    // The most recent process to run may have had interrupts
+    // turned off; enable them to avoid a deadlock if all
+    // processes are waiting.
+    intr_on();
+
+    // Take the next process off this CPU's run queue, or
+    // steal one from a busier CPU. The run queue's policy
+    // decides which one (see sched.c).
+    if((p = runqget()) == 0){
+      // Nothing to run: sleep until an interrupt.
+      intr_off();
+      runqidle();
+      continue;
+    }
 
-  for(;;)
-  {
-      // Enable interrupts on this processor.
-      intr_on();
-
-      // Loop over process table looking for process to run.
-      for(p = proc; p < &proc[NPROC]; p++)
-      {
-          acquire(&p->lock);
-
-          #ifdef DEFAULT
-              if(p->state != RUNNABLE) {
-                release(&p->lock);
-                continue;
-              }
-          #else
-          #ifdef PRIORITY
-
-              struct proc *highP = 0;
-              struct proc *p1 = 0;
-
-              if(p->state != RUNNABLE) {
-                release(&p->lock);
-                continue;
-              }
-              // Choose the process with highest priority (among RUNNABLEs)
-              highP = p;
-              for(p1 = proc; p1 < &proc[NPROC]; p1++){
-                acquire(&p1->lock);
-                if((p1->state == RUNNABLE) && (highP->priority > p1->priority))
-                  highP = p1;
-                release(&p1->lock);
-              }
-
-              if(highP != 0)
-                p = highP;
-
-          #else
-          #ifdef FCFS
-
-            struct proc *minP = 0;
-
-            if(p->state != RUNNABLE) {
-              release(&p->lock);
-              continue;
-            }
-
-            // ignore init and sh processes from FCFS
-            if(p->pid > 1)
-            {
-              if (minP != 0){
-                // here I find the process with the lowest creation time (the first one that was created)
-                if(p->ctime < minP->ctime)
-                  minP = p;
-              }
-              else
-                  minP = p;
-            }
-
-            // If I found the process which I created first and it is runnable I run it
-            if(minP != 0 && minP->state == RUNNABLE)
-                p = minP;
-          #else
-          #ifdef LOTTERY
-
-            if(p->state != RUNNABLE) {
-              release(&p->lock);
-              continue;
-            }
-
-            int totalT = totalTickets();
-            int draw = -1;
-
-          	if (totalT > 0 || draw <= 0)
-          		draw = random(totalT);
-
-            draw = draw - p->tickets;
-
-            // process with a great number of tickets has more probability to put draw to 0 or negative and execute
-            if(draw >= 0) {
-              release(&p->lock);
-              continue;
-            }
-          #else
-          #ifdef SML
-
-            struct proc *foundP = 0;
-
-            uint priority = 1;
-
-            int index1 = 0;
-            int index2 = 0;
-            int index3 = 0;
-
-            foundP = findReadyProcess(&index1, &index2, &index3, &priority);
-            if (foundP != 0)
-              p = foundP;
-            else{
-              if(p->state != RUNNABLE) {
-                release(&p->lock);
-                continue;
-              }
-            }
-
-          #endif
-          #endif
-          #endif
-          #endif
-          #endif
-
-          if(p != 0 && p->state == RUNNABLE)
-          {
-            // Switch to chosen process.  It is the process's job
-            // to release its lock and then reacquire it
-            // before jumping back to us.
-            c->proc = p;
-            p->state = RUNNING;
-
-            swtch(&c->context, &p->context);
-
-            // Process is done running for now.
-            // It should have changed its p->state before coming back.
-            c->proc = 0;
-          }
-          release(&p->lock);
-        }
+    acquire(&p->lock);
+    if(p->state == RUNNABLE) {
+      // Switch to chosen process.  It is the process's job
+      // to release its lock and then reacquire it
+      // before jumping back to us.
+      runqstart(p);
+      setstate(p, RUNNING);
+      TRACE(TRACE_SWITCHIN, p->pid, RUNNABLE, RUNNING);
+      p->cpu = cpuid();
+      // p's kernel stack may have been mapped since
+      // this hart last flushed its TLB.
+      if(c->kstackgen != kstackgen){
+        c->kstackgen = kstackgen;
+        sfence_vma();
+      }
+      p->runstart = p->stamp;
+      c->proc = p;
+      swtch(&c->context, &p->context);
+
+      // Process is done running for now.
+      // It should have changed its p->state before coming back.
+      c->proc = 0;
+
+      // Requeue p if it is still RUNNABLE, and let the
+      // policy charge it for the time it ran.
+      runqdone(p, p->stamp - p->runstart);
+    }
+    release(&p->lock);
   }
 }
 
@@ -627,6 +843,7 @@ sched(void)
   if(intr_get())
     panic("sched interruptible");
 
+  TRACE(TRACE_SWITCHOUT, p->pid, RUNNING, p->state);
   intena = mycpu()->intena;
   swtch(&p->context, &mycpu()->context);
   mycpu()->intena = intena;
@@ -638,7 +855,7 @@ yield(void)
 {
   struct proc *p = myproc();
   acquire(&p->lock);
-  p->state = RUNNABLE;
+  setstate(p, RUNNABLE);
   sched();
   release(&p->lock);
 }
@@ -667,12 +884,54 @@ forkret(void)
   usertrapret();
 }
 
+// The sleep queue of chan. Channels are addresses, so drop
+// the low bits that are the same for most of them.
+static struct sleepq*
+sleepq(void *chan)
+{
+  uint64 h = (uint64)chan;
+
+  h ^= h >> 16;
+  return &sleepqs[(h >> 3) % NSLEEPQ];
+}
+
+// Caller must hold q->lock.
+static void
+sqpush(struct sleepq *q, struct proc *p, void *chan)
+{
+  p->chan = chan;
+  p->sq = q;
+  p->sqprev = 0;
+  p->sqnext = q->head;
+  if(q->head)
+    q->head->sqprev = p;
+  q->head = p;
+}
+
+// Caller must hold p->sq->lock.
+static void
+sqremove(struct proc *p)
+{
+  struct sleepq *q = p->sq;
+
+  if(p->sqprev)
+    p->sqprev->sqnext = p->sqnext;
+  else
+    q->head = p->sqnext;
+  if(p->sqnext)
+    p->sqnext->sqprev = p->sqprev;
+  p->sqnext = p->sqprev = 0;
+  p->sq = 0;
+  p->chan = 0;
+}
+
 // Atomically release lock and sleep on chan.
 // Reacquires lock when awakened.
 void
 sleep(void *chan, struct spinlock *lk)
 {
   struct proc *p = myproc();
+  struct sleepq *q = sleepq(chan);
   
   // Must acquire p->lock in order to
   // change p->state and then call sched.
@@ -681,20 +940,29 @@ sleep(void *chan, struct spinlock *lk)
   // (wakeup locks p->lock),
   // so it's okay to release lk.
 
+  acquire(&q->lock);
   acquire(&p->lock);  //DOC: sleeplock1
+  sqpush(q, p, chan);
+  release(&q->lock);
   release(lk);
 
   // Go to sleep.
-  p->chan = chan;
-  p->state = SLEEPING;
+  setstate(p, SLEEPING);
+  p->nvcsw++;
 
   sched();
 
-  // Tidy up.
-  p->chan = 0;
+  release(&p->lock);
+
+  // Tidy up. wakeup() has dequeued p unless kill() woke it;
+  // only this process dequeues it then, so p->sq is stable.
+  if(p->sq){
+    acquire(&q->lock);
+    sqremove(p);
+    release(&q->lock);
+  }
 
   // Reacquire original lock.
-  release(&p->lock);
   acquire(lk);
 }
 
@@ -703,17 +971,23 @@ sleep(void *chan, struct spinlock *lk)
 void
 wakeup(void *chan)
 {
-  struct proc *p;
+  struct sleepq *q = sleepq(chan);
+  struct proc *p, *next;
 
-  for(p = proc; p < &proc[NPROC]; p++) {
-    if(p != myproc()){
+  acquire(&q->lock);
+  for(p = q->head; p; p = next) {
+    next = p->sqnext;
+    if(p != myproc() && p->chan == chan){
       acquire(&p->lock);
-      if(p->state == SLEEPING && p->chan == chan) {
-        p->state = RUNNABLE;
+      if(p->state == SLEEPING) {
+        sqremove(p);
+        TRACE(TRACE_WAKEUP, p->pid, SLEEPING, RUNNABLE);
+        setrunnable(p);
       }
       release(&p->lock);
     }
   }
+  release(&q->lock);
 }
 
 // Kill the process with the given pid.
@@ -724,20 +998,15 @@ kill(int pid)
 {
   struct proc *p;
 
-  for(p = proc; p < &proc[NPROC]; p++){
-    acquire(&p->lock);
-    if(p->pid == pid){
-      p->killed = 1;
-      if(p->state == SLEEPING){
-        // Wake process from sleep().
-        p->state = RUNNABLE;
-      }
-      release(&p->lock);
-      return 0;
-    }
-    release(&p->lock);
+  if((p = findproc(pid)) == 0)
+    return -1;
+  p->killed = 1;
+  if(p->state == SLEEPING){
+    // Wake process from sleep().
+    setrunnable(p);
   }
-  return -1;
+  release(&p->lock);
+  return 0;
 }
 
 void
@@ -805,9 +1074,11 @@ procdump(void)
   };
   struct proc *p;
   char *state;
+  int i;
 
   printf("\n");
-  for(p = proc; p < &proc[NPROC]; p++){
+  for(i = 0; i < nslot; i++){
+    p = procs[i];
     if(p->state == UNUSED)
       continue;
     if(p->state >= 0 && p->state < NELEM(states) && states[p->state])
@@ -819,226 +1090,173 @@ procdump(void)
   }
 }
 
-/*
-  This method will run every clock tick and update the statistic fields for each proc
-*/
-void updatestatistics() {
-  struct proc *p;
-  for(p = proc; p < &proc[NPROC]; p++){
-    acquire(&p->lock);
-    switch(p->state) {
-      case SLEEPING:
-        p->stime++;
-        break;
-      case RUNNABLE:
-        p->retime++;
-        break;
-      case RUNNING:
-        p->rutime++;
-        break;
-      default:
-        ;
-    }
-    release(&p->lock);
+// Move p to state, charging the time since its last state
+// change to the state it leaves. Times are kept in r_time()
+// cycles, so they need no per-tick scan of the process table.
+// Caller must hold p->lock.
+void
+setstate(struct proc *p, int state)
+{
+  uint64 now = r_time();
+  uint64 d = now - p->stamp;
+
+  switch(p->state){
+  case SLEEPING:
+    p->stime += d;
+    break;
+  case RUNNABLE:
+    p->retime += d;
+    break;
+  case RUNNING:
+    p->rutime += d;
+    break;
+  default:
+    break;
   }
+  p->stamp = now;
+  p->state = state;
 }
 
-/* This method is used to generate a random number, between 0 and M
-This is a modified version of the LFSR alogrithm
-found here: http://goo.gl/At4AIC */
+// Change Process priority
 int
-random(int max) {
-
-  if(max <= 0) {
-    return 1;
-  }
+chpr(int pid, int priority)
+{
+  struct proc *p;
 
-  static int z1 = 12345; // 12345 for rest of zx
-  static int z2 = 12345; // 12345 for rest of zx
-  static int z3 = 12345; // 12345 for rest of zx
-  static int z4 = 12345; // 12345 for rest of zx
-
-  int b;
-  b = (((z1 << 6) ^ z1) >> 13);
-  z1 = (((z1 & 4294967294) << 18) ^ b);
-  b = (((z2 << 2) ^ z2) >> 27);
-  z2 = (((z2 & 4294967288) << 2) ^ b);
-  b = (((z3 << 13) ^ z3) >> 21);
-  z3 = (((z3 & 4294967280) << 7) ^ b);
-  b = (((z4 << 3) ^ z4) >> 12);
-  z4 = (((z4 & 4294967168) << 13) ^ b);
-
-  // if we have an argument, then we can use it
-  int rand = ((z1 ^ z2 ^ z3 ^ z4)) % max;
-
-  if(rand < 0) {
-    rand = rand * -1;
+  if((p = findproc(pid)) != 0){
+    p->priority = priority;
+    runqrequeue(p);
+    release(&p->lock);
   }
 
-  return rand;
+  return pid;
 }
 
-/* This method counts the total number of tickets that the runnable processes have
-(the lottery is done only of the process which can execute) */
+// Move process pid to scheduling class, with priority prio
+// (1 to NRTPRIO, 1 the highest) if it is CLASS_RT.
 int
-totalTickets(void) {
-
-	struct proc *p;
-	int total = 0;
-	for (p = proc; p < &proc[NPROC]; p++) {
-    acquire(&p->lock);
-		if (p->state == RUNNABLE) {
-			total += p->tickets;
-		}
-    release(&p->lock);
-	}
-
-	return total;
-}
+setclass(int pid, int class, int prio)
+{
+  struct proc *p;
 
-#ifdef SML
-/*
-  this method will find the next process to run
-*/
-struct proc* findReadyProcess(int *index1, int *index2, int *index3, uint *priority) {
-  int i;
-  struct proc* proc2;
-notfound:
-  for (i = 0; i < NPROC; i++) {
-    switch(*priority) {
-      case 1:
-        proc2 = &proc[(*index1 + i) % NPROC];
-        acquire(&proc2->lock);
-        if (proc2->state == RUNNABLE && proc2->priority == *priority) {
-          *index1 = (*index1 + 1 + i) % NPROC;
-          release(&proc2->lock);
-          return proc2; // found a runnable process with appropriate priority
-        }
-        release(&proc2->lock);
-      case 2:
-        proc2 = &proc[(*index2 + i) % NPROC];
-        acquire(&proc2->lock);
-        if (proc2->state == RUNNABLE && proc2->priority == *priority) {
-          *index2 = (*index2 + 1 + i) % NPROC;
-          release(&proc2->lock);
-          return proc2; // found a runnable process with appropriate priority
-        }
-        release(&proc2->lock);
-      case 3:
-        proc2 = &proc[(*index3 + i) % NPROC];
-        acquire(&proc2->lock);
-        if (proc2->state == RUNNABLE && proc2->priority == *priority){
-          *index3 = (*index3 + 1 + i) % NPROC;
-          release(&proc2->lock);
-          return proc2; // found a runnable process with appropriate priority
-        }
-        release(&proc2->lock);
-    }
-  }
-  if (*priority == 3) {//did not find any process on any of the prorities
-    *priority = 3;
-    return 0;
-  }
-  else {
-    *priority += 1; //will try to find a process at a lower priority (ighter value of priority)
-    goto notfound;
-  }
-  return 0;
+  if(class != CLASS_RT && class != CLASS_NORMAL && class != CLASS_IDLE)
+    return -1;
+  if(class == CLASS_RT && (prio < 1 || prio > NRTPRIO))
+    return -1;
+  if((p = findproc(pid)) == 0)
+    return -1;
+  p->class = class;
+  p->rtprio = class == CLASS_RT ? prio : 0;
+  runqrequeue(p);
+  release(&p->lock);
+  return pid;
 }
-#endif
 
-// Change Process priority
+// Change Process tickets
 int
-chpr(int pid, int priority)
+chtickets(int pid, int tickets)
 {
   struct proc *p;
 
-  for(p = proc; p < &proc[NPROC]; p++){
-    acquire(&p->lock);
-    if(p->pid == pid) {
-        p->priority = priority;
-        release(&p->lock);
-        break;
-    }
+  if((p = findproc(pid)) != 0){
+    p->tickets = tickets;
+    runqrequeue(p);
     release(&p->lock);
   }
 
   return pid;
 }
 
-// Change Process tickets
+// Create a ticket currency funded with funding base tickets
+// and move the calling process into it. Children forked
+// afterwards share the currency's funding with it.
 int
-chtickets(int pid, int tickets)
+mkcurrency(int funding)
 {
-  struct proc *p;
+  struct proc *p = myproc();
+  int id;
 
-  for(p = proc; p < &proc[NPROC]; p++){
-    acquire(&p->lock);
-    if(p->pid == pid) {
-        p->tickets = tickets;
-        release(&p->lock);
-        break;
-    }
-    release(&p->lock);
-  }
+  acquire(&p->lock);
+  id = curralloc(p, funding);
+  release(&p->lock);
+  return id;
+}
+
+// Move process pid into ticket currency id (0 for base).
+int
+chcurrency(int pid, int id)
+{
+  struct proc *p;
 
+  if((p = findproc(pid)) == 0)
+    return -1;
+  if(setcurrency(p, id) < 0)
+    pid = -1;
+  release(&p->lock);
   return pid;
 }
 
-int wait2(uint64 retime_addr, uint64 rutime_addr, uint64 stime_addr) {
+// Fill in ps from p, counting the time p has spent in its
+// current state so far. Caller must hold wait_lock and p->lock.
+static void
+statproc(struct procstat *ps, struct proc *p)
+{
+  uint64 d = r_time() - p->stamp;
+
+  memset(ps, 0, sizeof(*ps));
+  ps->version = PROCSTAT_VERSION;
+  ps->pid = p->pid;
+  ps->ppid = p->parent ? p->parent->pid : 0;
+  ps->state = p->state;
+  ps->cpu = p->cpu;
+  ps->policy = schedid(p);
+  ps->priority = p->priority;
+  ps->tickets = p->tickets;
+  ps->ctime = p->ctime;
+  ps->retime = p->retime + (p->state == RUNNABLE ? d : 0);
+  ps->rutime = p->rutime + (p->state == RUNNING ? d : 0);
+  ps->stime = p->stime + (p->state == SLEEPING ? d : 0);
+  ps->sz = p->sz;
+  ps->rss = p->rss;
+  ps->pgfaults = p->pgfaults;
+  ps->dlmisses = p->dlmisses;
+  safestrcpy(ps->name, p->name, sizeof(ps->name));
+}
+
+// Copy records of up to n live processes to the user array
+// of struct procstat at addr. The records are gathered into a
+// kernel buffer in one pass under wait_lock, so that they are
+// a snapshot of one moment, and copied out together.
+// Returns the number of records copied, or -1.
+int
+procstat(uint64 addr, int n)
+{
+  struct procstat *buf;
   struct proc *p;
-  int havekids, pid;
-  struct proc *curproc = myproc();
-  
-  acquire(&wait_lock);
-  for(;;){
-    // Scan through table looking for zombie children.
-    havekids = 0;
-    for(p = proc; p < &proc[NPROC]; p++){
-      if(p->parent != curproc)
-        continue;
-      havekids = 1;
-      acquire(&p->lock);
-      if(p->state == ZOMBIE){
-        // Found one.
-        pid = p->pid;
-        
-        // Copy statistics to user space
-        if(retime_addr != 0 && copyout(curproc->pagetable, retime_addr, (char *)&p->retime, sizeof(p->retime)) < 0) {
-          release(&p->lock);
-          release(&wait_lock);
-          return -1;
-        }
-        if(rutime_addr != 0 && copyout(curproc->pagetable, rutime_addr, (char *)&p->rutime, sizeof(p->rutime)) < 0) {
-          release(&p->lock);
-          release(&wait_lock);
-          return -1;
-        }
-        if(stime_addr != 0 && copyout(curproc->pagetable, stime_addr, (char *)&p->stime, sizeof(p->stime)) < 0) {
-          release(&p->lock);
-          release(&wait_lock);
-          return -1;
-        }
-        
-        freeproc(p);
-        release(&p->lock);
-        release(&wait_lock);
-        return pid;
-      }
-      release(&p->lock);
-    }
+  int i, k;
 
-    // No point waiting if we don't have any children.
-    if(!havekids || killed(curproc)){
-      release(&wait_lock);
-      return -1;
-    }
+  if(n < 0)
+    return -1;
+  if(n > nslot)
+    n = nslot;
+  if(n == 0)
+    return 0;
+  if((buf = (struct procstat*)kallocn(n * sizeof(*buf))) == 0)
+    return -1;
 
-    // Wait for children to exit.
-    sleep(curproc, &wait_lock);
+  k = 0;
+  acquire(&wait_lock);
+  for(i = 0; i < nslot && k < n; i++){
+    p = procs[i];
+    acquire(&p->lock);
+    if(p->state != UNUSED)
+      statproc(&buf[k++], p);
+    release(&p->lock);
   }
-}
+  release(&wait_lock);
 
-struct proc *getptable_proc(void) {
-  return proc;
+  if(copyout(myproc()->pagetable, addr, (char*)buf, k * sizeof(*buf)) < 0)
+    k = -1;
+  kfree(buf);
+  return k;
 }
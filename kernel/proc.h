@@ -24,6 +24,14 @@ struct cpu {
   struct context context;     // swtch() here to enter scheduler().
   int noff;                   // Depth of push_off() nesting.
   int intena;                 // Were interrupts enabled before push_off()?
+  uint rand[4];               // Lottery generator state, see random() in sched.c
+  int idle;                   // Waiting for an interrupt in runqidle()?
+  int resched;                // Should proc give up the cpu at its next trap?
+  struct proc *picked;        // Picked by runqget() to run next, or null
+  uint64 online;              // r_time() when this cpu started scheduling
+  uint64 idletime;            // Cycles spent in runqidle()
+  uint64 idlestart;           // r_time() when the current wait began, or 0
+  uint kstackgen;             // kstackgen when this cpu last flushed its TLB
 };
 
 extern struct cpu cpus[NCPU];
@@ -89,15 +97,31 @@ struct proc {
 
   // p->lock must be held when using these:
   enum procstate state;        // Process state
-  void *chan;                  // If non-zero, sleeping on chan
   int killed;                  // If non-zero, have been killed
   int xstate;                  // Exit status to be returned to parent's wait
   int pid;                     // Process ID
 
-  // wait_lock must be held when using this:
+  // wait_lock must be held when using these:
   struct proc *parent;         // Parent process
+  struct proc *children;       // Children that haven't exited
+  struct proc *zombies;        // Children that have exited, not yet reaped
+  struct proc *sibnext;        // Next process on parent's children or zombies
+  struct proc *sibprev;        // Previous process on that list
+
+  // pid_lock must be held when using this:
+  struct proc *pidnext;        // Next process in p's pid hash chain
+
+  // the lock of p's sleep queue must be held to change these:
+  void *chan;                  // If non-zero, sleeping on chan
+  struct sleepq *sq;           // Sleep queue p is on, or null
+  struct proc *sqnext;         // Next process on sq
+  struct proc *sqprev;         // Previous process on sq
+
+  // proc_lock must be held when using this:
+  struct proc *nextfree;       // Next unused slot
 
   // these are private to the process, so p->lock need not be held.
+  int slot;                    // Index of p in procs[]
   uint64 kstack;               // Virtual address of kernel stack
   uint64 sz;                   // Size of process memory (bytes)
   pagetable_t pagetable;       // User page table
@@ -106,12 +130,70 @@ struct proc {
   struct file *ofile[NOFILE];  // Open files
   struct inode *cwd;           // Current directory
   char name[16];               // Process name (debugging)
+  uint64 pgfaults;             // Page faults taken
+  uint64 rss;                  // Resident user pages, see rssadd()
+  uint64 maxrss;               // Peak resident user pages, see notemaxrss()
+  uint64 nvcsw;                // Times p gave up the CPU itself
+  uint64 nivcsw;               // Times the timer took the CPU from p
   
   // Scheduling fields
-  int priority;                // Process priority (for PRIORITY and SML)
+  int priority;                // Process priority (for PRIORITY, SML and FAIR)
   uint ctime;                  // Process creation time
-  int stime;                   // Process SLEEPING time
-  int retime;                  // Process READY (RUNNABLE) time
-  int rutime;                  // Process RUNNING time
+  uint64 stime;                // Process SLEEPING time, in r_time() cycles
+  uint64 retime;               // Process READY (RUNNABLE) time, in cycles
+  uint64 rutime;               // Process RUNNING time, in cycles
+  uint64 stamp;                // r_time() at the last state change
   int tickets;                 // Process tickets (for LOTTERY scheduling)
+  int currency;                // LOTTERY currency of p's tickets, 0 for base
+  int curactive;               // Tickets p has active in its currency
+  uint64 used;                 // Cycles used before blocking early, else 0
+  uint64 remain;               // STRIDE pass p rejoins its run queue with
+  uint64 vruntime;             // FAIR weighted running time, in cycles
+  int mlfqlevel;               // MLFQ level, 0 being the highest
+  int mlfqticks;               // Ticks used of the MLFQ level's allotment
+  uint mlfqepoch;              // MLFQ boost period of mlfqlevel
+  uint64 predict;              // SRTF predicted length of the next CPU burst
+  uint64 burstran;             // SRTF cycles run so far of the current burst
+  int srtfticks;               // SRTF ticks taken in the current slice
+
+  // Deadline parameters and the current job; see sched_deadline.c.
+  int dlruntime;               // Budget per period, in ticks
+  int dlperiod;                // Period in ticks, 0 if not a deadline process
+  int dldeadline;              // Deadline after each release, in ticks
+  uint64 dlbw;                 // Bandwidth reserved by admission control
+  uint dlnext;                 // Tick the next job is released at
+  uint dldead;                 // Tick the current job is due by
+  uint64 dlleft;               // Cycles of budget the current job has left
+  int dlover;                  // Current job is done or missed its deadline
+  int dlmisses;                // Deadlines missed
+  int dlticks;                 // Ticks taken in the current slice
+  int class;                   // Scheduling class outside deadline jobs
+  int rtprio;                  // CLASS_RT priority, 1 being the highest
+  int idleticks;               // CLASS_IDLE ticks taken in the current slice
+  int borrowed;                // Tickets lent to p by processes it serves
+  uint64 runstart;             // r_time() when p was last dispatched
+  int woken;                   // Woken up and not yet run since
+
+  // private to the process; see ticketlend() in sched.c.
+  struct proc *lendee;         // Process p lends its tickets to while blocked
+  int lendpid;                 // lendee's pid, in case its slot was reused
+  int lent;                    // Tickets lent to lendee
+
+  // the lock of the run queue p is on must be held when using these:
+  struct runq *rq;             // Run queue p is on, or null
+  struct schedpolicy *policy;  // Policy p was last queued under
+  struct proc *rqnext;         // Next process on the run queue
+  struct proc *rqprev;         // Previous process on the run queue
+  int rqlevel;                 // Level of the run queue p is on
+  int rqtickets;               // Tickets p counts for on the run queue
+  uint64 rqkey;                // Run queue heap key, e.g. STRIDE pass
+  uint64 rqseq;                // Heap insertion order, breaks key ties
+  int heapidx;                 // Index of p in the run queue heap
+  int rqclass;                 // Class queued in, or last taken off in
+
+  // p->lock must be held when using this:
+  int cpu;                     // CPU p last ran on; its run queue gets p
 };
+
+extern struct proc *procs[NPROC];
+extern int nslot;
@@ -0,0 +1,23 @@
+// One process, as reported by procstat(). Bump
+// PROCSTAT_VERSION whenever the layout changes.
+#define PROCSTAT_VERSION 2
+
+struct procstat {
+  int version;                 // PROCSTAT_VERSION
+  int pid;                     // Process ID
+  int ppid;                    // Parent's pid, 0 if none
+  int state;                   // enum procstate
+  int cpu;                     // CPU last run on
+  int policy;                  // SCHED_* policy last queued under, -1 if none
+  int priority;                // Priority (PRIORITY, SML and FAIR)
+  int tickets;                 // Tickets (LOTTERY and STRIDE)
+  uint ctime;                  // Creation time, in ticks
+  uint64 retime;               // RUNNABLE time, in r_time() cycles
+  uint64 rutime;               // RUNNING time, in cycles
+  uint64 stime;                // SLEEPING time, in cycles
+  uint64 sz;                   // Size of process memory (bytes)
+  uint64 rss;                  // Resident user pages
+  uint64 pgfaults;             // Page faults taken
+  int dlmisses;                // Deadlines missed (deadline processes)
+  char name[16];               // Process name
+};
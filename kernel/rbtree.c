@@ -0,0 +1,255 @@
+// Red-black trees, as in CLRS chapter 13.
+//
+// The tree caches its leftmost node, so the smallest element
+// is found in O(1); insert and erase take O(log n). Equal keys
+// go to the right of each other, so they come out in the order
+// they went in. Callers do their own locking.
+
+#include "types.h"
+#include "riscv.h"
+#include "rbtree.h"
+#include "defs.h"
+
+static int
+isred(struct rbnode *n)
+{
+  return n && n->red;
+}
+
+static void
+rotateleft(struct rbtree *t, struct rbnode *x)
+{
+  struct rbnode *y = x->right;
+
+  x->right = y->left;
+  if(y->left)
+    y->left->parent = x;
+  y->parent = x->parent;
+  if(x->parent == 0)
+    t->root = y;
+  else if(x == x->parent->left)
+    x->parent->left = y;
+  else
+    x->parent->right = y;
+  y->left = x;
+  x->parent = y;
+}
+
+static void
+rotateright(struct rbtree *t, struct rbnode *x)
+{
+  struct rbnode *y = x->left;
+
+  x->left = y->right;
+  if(y->right)
+    y->right->parent = x;
+  y->parent = x->parent;
+  if(x->parent == 0)
+    t->root = y;
+  else if(x == x->parent->right)
+    x->parent->right = y;
+  else
+    x->parent->left = y;
+  y->right = x;
+  x->parent = y;
+}
+
+// Insert n, using less(a, b) to tell whether a sorts before b.
+void
+rbinsert(struct rbtree *t, struct rbnode *n, int (*less)(struct rbnode*, struct rbnode*))
+{
+  struct rbnode *x, *y, *g, *u;
+  int left, leftmost;
+
+  // Plain binary tree insert.
+  y = 0;
+  left = 0;
+  leftmost = 1;
+  for(x = t->root; x; x = left ? x->left : x->right){
+    y = x;
+    left = less(n, x);
+    if(!left)
+      leftmost = 0;
+  }
+  n->parent = y;
+  n->left = n->right = 0;
+  n->red = 1;
+  if(y == 0)
+    t->root = n;
+  else if(left)
+    y->left = n;
+  else
+    y->right = n;
+  if(leftmost)
+    t->first = n;
+
+  // Repair red nodes with red parents.
+  while(isred(y = n->parent)){
+    g = y->parent;  // exists, since the root is black
+    if(y == g->left){
+      u = g->right;
+      if(isred(u)){
+        y->red = u->red = 0;
+        g->red = 1;
+        n = g;
+      } else {
+        if(n == y->right){
+          rotateleft(t, y);
+          y = n;
+        }
+        y->red = 0;
+        g->red = 1;
+        rotateright(t, g);
+        break;
+      }
+    } else {
+      u = g->left;
+      if(isred(u)){
+        y->red = u->red = 0;
+        g->red = 1;
+        n = g;
+      } else {
+        if(n == y->left){
+          rotateright(t, y);
+          y = n;
+        }
+        y->red = 0;
+        g->red = 1;
+        rotateleft(t, g);
+        break;
+      }
+    }
+  }
+  t->root->red = 0;
+}
+
+// The node after n in order, or null.
+static struct rbnode*
+rbnext(struct rbnode *n)
+{
+  struct rbnode *p;
+
+  if(n->right){
+    for(n = n->right; n->left; n = n->left)
+      ;
+    return n;
+  }
+  for(p = n->parent; p && n == p->right; p = p->parent)
+    n = p;
+  return p;
+}
+
+// Put v where u is in u's parent.
+static void
+transplant(struct rbtree *t, struct rbnode *u, struct rbnode *v)
+{
+  if(u->parent == 0)
+    t->root = v;
+  else if(u == u->parent->left)
+    u->parent->left = v;
+  else
+    u->parent->right = v;
+  if(v)
+    v->parent = u->parent;
+}
+
+// Remove n, which must be in t.
+void
+rberase(struct rbtree *t, struct rbnode *n)
+{
+  struct rbnode *x, *xp, *y, *w;
+  int red;
+
+  if(t->first == n)
+    t->first = rbnext(n);
+
+  // Unlink n, or its successor y if n has two children.
+  // x takes the place of the node that was removed, and
+  // xp is x's parent, since x may be null.
+  red = n->red;
+  if(n->left == 0){
+    x = n->right;
+    xp = n->parent;
+    transplant(t, n, x);
+  } else if(n->right == 0){
+    x = n->left;
+    xp = n->parent;
+    transplant(t, n, x);
+  } else {
+    for(y = n->right; y->left; y = y->left)
+      ;
+    red = y->red;
+    x = y->right;
+    if(y->parent == n){
+      xp = y;
+    } else {
+      xp = y->parent;
+      transplant(t, y, x);
+      y->right = n->right;
+      y->right->parent = y;
+    }
+    transplant(t, n, y);
+    y->left = n->left;
+    y->left->parent = y;
+    y->red = n->red;
+  }
+  if(red)
+    return;
+
+  // A black node went away, so x's side is one black short.
+  while(x != t->root && !isred(x)){
+    if(x == xp->left){
+      w = xp->right;
+      if(isred(w)){
+        w->red = 0;
+        xp->red = 1;
+        rotateleft(t, xp);
+        w = xp->right;
+      }
+      if(!isred(w->left) && !isred(w->right)){
+        w->red = 1;
+        x = xp;
+        xp = x->parent;
+      } else {
+        if(!isred(w->right)){
+          w->left->red = 0;
+          w->red = 1;
+          rotateright(t, w);
+          w = xp->right;
+        }
+        w->red = xp->red;
+        xp->red = 0;
+        w->right->red = 0;
+        rotateleft(t, xp);
+        x = t->root;
+      }
+    } else {
+      w = xp->left;
+      if(isred(w)){
+        w->red = 0;
+        xp->red = 1;
+        rotateright(t, xp);
+        w = xp->left;
+      }
+      if(!isred(w->left) && !isred(w->right)){
+        w->red = 1;
+        x = xp;
+        xp = x->parent;
+      } else {
+        if(!isred(w->left)){
+          w->right->red = 0;
+          w->red = 1;
+          rotateleft(t, w);
+          w = xp->left;
+        }
+        w->red = xp->red;
+        xp->red = 0;
+        w->left->red = 0;
+        rotateright(t, xp);
+        x = t->root;
+      }
+    }
+  }
+  if(x)
+    x->red = 0;
+}
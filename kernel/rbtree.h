@@ -0,0 +1,12 @@
+// Red-black trees whose nodes live in the caller's structures.
+struct rbnode {
+  struct rbnode *parent;
+  struct rbnode *left;
+  struct rbnode *right;
+  int red;           // Is the node red? The root is always black.
+};
+
+struct rbtree {
+  struct rbnode *root;
+  struct rbnode *first;  // Leftmost (smallest) node, or null
+};
@@ -43,6 +43,20 @@ w_mstatus(uint64 x)
 /*----------------------------------------------------------
  * 异常处理相关寄存器
  *---------------------------------------------------------*/
+/* 写入机器模式陷阱向量基址寄存器(mtvec) */
+static inline void
+w_mtvec(uint64 x)
+{
+  asm volatile("csrw mtvec, %0" : : "r" (x));
+}
+
+/* 写入机器模式暂存寄存器(mscratch) */
+static inline void
+w_mscratch(uint64 x)
+{
+  asm volatile("csrw mscratch, %0" : : "r" (x));
+}
+
 /* 机器模式异常程序计数器(mepc) - 保存异常返回地址 */
 static inline void 
 w_mepc(uint64 x)
@@ -96,6 +110,8 @@ w_sip(uint64 x)
   asm volatile("csrw sip, %0" : : "r" (x));
 }
 
+#define SIP_SSIP (1L << 1) // 软件中断待处理
+
 /*----------------------------------------------------------
  * 中断使能寄存器
  *---------------------------------------------------------*/
@@ -123,6 +139,7 @@ w_sie(uint64 x)
  * 机器模式中断使能
  *---------------------------------------------------------*/
 #define MIE_STIE (1L << 5)  // 监管模式定时器中断使能
+#define MIE_MSIE (1L << 3)  // 机器模式软件中断(IPI)使能
 /* 读取机器模式中断使能寄存器 */
 static inline uint64
 r_mie()
@@ -361,6 +378,13 @@ intr_off()
   w_sstatus(r_sstatus() & ~SSTATUS_SIE);
 }
 
+/* 等待中断：sie 中使能的中断待处理时返回，即使设备中断已禁用 */
+static inline void
+wfi()
+{
+  asm volatile("wfi");
+}
+
 /* 检查设备中断是否启用 */
 static inline int
 intr_get()
@@ -0,0 +1,239 @@
+// Run queue structures shared by the scheduling policies, and
+// the queue operations on them. Nothing here touches the
+// hardware or takes a lock, so sim/ compiles this file and the
+// sched_*.c policies on the host as they are.
+//
+// A run queue holds a stack of scheduling classes (CLASS_* in
+// policy.h): deadline, real-time, normal and idle. rqpick()
+// takes the next process from the first class that has any,
+// and schedtick() preempts a process as soon as a higher class
+// has one queued. The normal class is ordered by the queue's
+// policy; the others have a table of the same hooks each,
+// in sched_deadline.c and sched_class.c. A process is in the
+// deadline class while its current job has budget left, and
+// otherwise in the class it chose with setclass().
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+// Index of the lowest set bit of x, which must be non-zero.
+static int
+lowbit(uint x)
+{
+  int n = 0;
+
+  if((x & 0xffff) == 0){ n += 16; x >>= 16; }
+  if((x & 0xff) == 0){ n += 8; x >>= 8; }
+  if((x & 0xf) == 0){ n += 4; x >>= 4; }
+  if((x & 0x3) == 0){ n += 2; x >>= 2; }
+  if((x & 0x1) == 0){ n += 1; }
+  return n;
+}
+
+// Append p to the tail of level l of rq.
+// Caller must hold rq->lock.
+void
+levelpush(struct runq *rq, struct proc *p, int l)
+{
+  struct level *lv = &rq->lv[l];
+
+  p->rqlevel = l;
+  p->rqnext = 0;
+  p->rqprev = lv->tail;
+  if(lv->tail)
+    lv->tail->rqnext = p;
+  else
+    lv->head = p;
+  lv->tail = p;
+  rq->bitmap |= 1 << l;
+}
+
+// Unlink p from its level of rq.
+// Caller must hold rq->lock.
+void
+levelremove(struct runq *rq, struct proc *p)
+{
+  struct level *lv = &rq->lv[p->rqlevel];
+
+  if(p->rqprev)
+    p->rqprev->rqnext = p->rqnext;
+  else
+    lv->head = p->rqnext;
+  if(p->rqnext)
+    p->rqnext->rqprev = p->rqprev;
+  else
+    lv->tail = p->rqprev;
+  if(lv->head == 0)
+    rq->bitmap &= ~(1 << p->rqlevel);
+  p->rqnext = p->rqprev = 0;
+}
+
+// The oldest process on the lowest non-empty level, or 0.
+// Caller must hold rq->lock.
+struct proc*
+levelfirst(struct runq *rq)
+{
+  if(rq->bitmap == 0)
+    return 0;
+  return rq->lv[lowbit(rq->bitmap)].head;
+}
+
+// Does a come before b in a heap?
+static int
+heapless(struct proc *a, struct proc *b)
+{
+  if(a->rqkey != b->rqkey)
+    return a->rqkey < b->rqkey;
+  return a->rqseq < b->rqseq;
+}
+
+// Put p at index i of h.
+static void
+heapset(struct heap *h, int i, struct proc *p)
+{
+  h->p[i] = p;
+  p->heapidx = i;
+}
+
+// Move the process at index i up or down until h is
+// ordered again.
+static void
+heapfix(struct heap *h, int i)
+{
+  struct proc *p = h->p[i];
+  int parent, child;
+
+  while(i > 0 && heapless(p, h->p[parent = (i - 1) / 2])){
+    heapset(h, i, h->p[parent]);
+    i = parent;
+  }
+  while((child = 2 * i + 1) < h->n){
+    if(child + 1 < h->n && heapless(h->p[child + 1], h->p[child]))
+      child++;
+    if(!heapless(h->p[child], p))
+      break;
+    heapset(h, i, h->p[child]);
+    i = child;
+  }
+  heapset(h, i, p);
+}
+
+// Add p to h, keyed on p->rqkey. h->p[0] is the process with
+// the smallest key; equal keys come out FIFO.
+// Caller must hold the lock of the run queue h is in.
+void
+heapinsert(struct heap *h, struct proc *p)
+{
+  p->rqseq = h->seq++;
+  heapset(h, h->n++, p);
+  heapfix(h, p->heapidx);
+}
+
+// Caller must hold the lock of the run queue h is in.
+void
+heapremove(struct heap *h, struct proc *p)
+{
+  int i = p->heapidx;
+
+  if(i >= h->n || h->p[i] != p)
+    panic("heapremove");
+  h->n--;
+  if(i < h->n){
+    heapset(h, i, h->p[h->n]);
+    heapfix(h, i);
+  }
+}
+
+// tick() of the policies that preempt on every timer
+// interrupt.
+int
+alwaystick(struct runq *rq, struct proc *p)
+{
+  return 1;
+}
+
+static struct schedpolicy *classes[NCLASS] = {
+[CLASS_DEADLINE] &dlclass,
+[CLASS_RT]       &rtclass,
+[CLASS_IDLE]     &idleclass,
+};
+
+// The hooks of class c on rq.
+struct schedpolicy*
+classof(struct runq *rq, int c)
+{
+  return c == CLASS_NORMAL ? rq->policy : classes[c];
+}
+
+// Queue p on rq in its class. A normal process that is waking
+// up, is new, or was last queued under another policy or in
+// another class goes through the policy's on_wakeup() first,
+// so that, e.g., FAIR doesn't trust a vruntime that stood
+// still while p ran as a real-time process.
+// Caller must hold rq->lock.
+void
+rqenqueue(struct runq *rq, struct proc *p, int wakeup)
+{
+  struct schedpolicy *pol = rq->policy;
+  int prev = p->rqclass;
+
+  p->rq = rq;
+  rq->n++;
+  dlcheck(p);
+  p->rqclass = dlactive(p) ? CLASS_DEADLINE : p->class;
+  rq->nclass[p->rqclass]++;
+  if(p->rqclass != CLASS_NORMAL){
+    classes[p->rqclass]->enqueue(rq, p);
+    return;
+  }
+
+  if(p->policy != pol || prev != CLASS_NORMAL){
+    p->policy = pol;
+    wakeup = 1;
+  }
+  if(wakeup && pol->on_wakeup)
+    pol->on_wakeup(rq, p);
+  pol->enqueue(rq, p);
+}
+
+// Take p off rq.
+// Caller must hold rq->lock.
+void
+rqdequeue(struct runq *rq, struct proc *p)
+{
+  if(p->rq != rq)
+    panic("rqdequeue");
+  classof(rq, p->rqclass)->dequeue(rq, p);
+  p->rq = 0;
+  rq->n--;
+  rq->nclass[p->rqclass]--;
+}
+
+// Take the process that should run next off rq, or return 0
+// if rq is empty: the choice of the highest class that has a
+// process queued. Only queued (hence RUNNABLE) processes are
+// examined, and their p->locks are not taken.
+// Caller must hold rq->lock.
+struct proc*
+rqpick(struct runq *rq)
+{
+  struct proc *p;
+  int c;
+
+  if(rq->n == 0)
+    return 0;
+  for(c = 0; rq->nclass[c] == 0; c++)
+    ;
+  if((p = classof(rq, c)->pick_next(rq)) == 0)
+    panic("rqpick");
+  rqdequeue(rq, p);
+  return p;
+}
@@ -0,0 +1,13 @@
+// waitpid() options.
+#define WNOHANG 1              // Return 0 rather than wait for a child
+
+// What a child used, as reported by waitpid().
+struct rusage {
+  uint64 retime;               // RUNNABLE time, in r_time() cycles
+  uint64 rutime;               // RUNNING time, in cycles
+  uint64 stime;                // SLEEPING time, in cycles
+  uint64 nvcsw;                // Voluntary context switches: sleep(), yield()
+  uint64 nivcsw;               // Involuntary ones: timer preemption
+  uint64 pgfaults;             // Page faults taken
+  uint64 maxrss;               // Peak resident user pages
+};
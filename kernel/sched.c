@@ -0,0 +1,513 @@
+// Per-CPU run queues.
+//
+// Every RUNNABLE process sits on exactly one run queue, except
+// while it is between runqget() and scheduler() switching to
+// it, or between yielding and scheduler() switching away from
+// it. setrunnable() puts a waking or new process on the queue
+// of the CPU it last ran on, and runqdone() puts back one that
+// yielded or was preempted. scheduler() takes the next process
+// off its own CPU's queue and, when that queue is empty, steals
+// one from the busiest other CPU. Processes that are not
+// runnable are never looked at, so an idle CPU only touches
+// NCPU queue locks instead of NPROC process locks.
+//
+// How a run queue is ordered is up to its policy, a table of
+// hooks (struct schedpolicy in sched.h) that each live in a
+// sched_*.c file. The queue keeps the structures policies
+// share (runq.c): FIFO levels with a bitmap of the non-empty
+// ones, found by levelfirst(), and a min-heap on p->rqkey.
+// SCHEDFLAG picks the policy the kernel boots with, and
+// setsched() switches every run queue to another one while the
+// system runs.
+//
+// A CPU with nothing to run waits in runqidle() with its
+// timer stopped (except CPU 0, which keeps ticks going) until
+// another CPU queues work and wakes it with kick().
+//
+// A process that wakes up ahead of the one running on its CPU
+// doesn't wait for that CPU's next tick: setrunnable() sets
+// the CPU's resched flag, and IPIs it if it is another CPU,
+// and the running process yields on its way out of the trap.
+//
+// Lock order: schedlock, then p->lock, then a run queue lock.
+// A CPU never holds more than one run queue lock at a time.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "schedlat.h"
+#include "trace.h"
+#include "defs.h"
+
+#if defined(PRIORITY)
+#define BOOTPOLICY SCHED_PRIORITY
+#elif defined(FCFS)
+#define BOOTPOLICY SCHED_FCFS
+#elif defined(LOTTERY)
+#define BOOTPOLICY SCHED_LOTTERY
+#elif defined(SML)
+#define BOOTPOLICY SCHED_SML
+#elif defined(STRIDE)
+#define BOOTPOLICY SCHED_STRIDE
+#elif defined(FAIR)
+#define BOOTPOLICY SCHED_FAIR
+#elif defined(MLFQ)
+#define BOOTPOLICY SCHED_MLFQ
+#elif defined(SRTF)
+#define BOOTPOLICY SCHED_SRTF
+#else
+#define BOOTPOLICY SCHED_DEFAULT
+#endif
+
+static struct schedpolicy *policies[] = {
+[SCHED_DEFAULT]  &rrpolicy,
+[SCHED_PRIORITY] &priopolicy,
+[SCHED_FCFS]     &fcfspolicy,
+[SCHED_LOTTERY]  &lotterypolicy,
+[SCHED_SML]      &smlpolicy,
+[SCHED_STRIDE]   &stridepolicy,
+[SCHED_FAIR]     &fairpolicy,
+[SCHED_MLFQ]     &mlfqpolicy,
+[SCHED_SRTF]     &srtfpolicy,
+};
+
+static struct runq runqs[NCPU];
+
+// Written by each CPU only for itself, with interrupts off,
+// so no lock is needed; readers may see it mid-update.
+static struct schedlat lat;
+
+// The policy new processes start under. setsched() holds
+// schedlock while it moves every run queue to a new one.
+static int curpolicy = BOOTPOLICY;
+static struct spinlock schedlock;
+
+void
+runqinit(void)
+{
+  struct runq *rq;
+
+  initlock(&schedlock, "sched");
+  for(rq = runqs; rq < &runqs[NCPU]; rq++){
+    initlock(&rq->lock, "runq");
+    rq->policy = policies[curpolicy];
+  }
+  lotteryinit();
+  dlinit();
+}
+
+// Work has been queued on CPU id's run queue. If that CPU is
+// idle, wake it; otherwise wake some other idle CPU, which
+// will steal the work if id doesn't get to it first.
+// Interrupts must be disabled.
+static void
+kick(int id)
+{
+  int i, c;
+
+  // pairs with the barrier in runqidle(): either we see the
+  // idle flag, or the idle CPU sees the queued work.
+  __sync_synchronize();
+  for(i = 0; i < NCPU; i++){
+    c = (id + i) % NCPU;
+    if(cpus[c].idle){
+      if(c != cpuid())
+        ipi(c);
+      return;
+    }
+  }
+}
+
+// Make the process running on CPU id yield at its next trap,
+// and interrupt CPU id so that it traps now. runqget() clears
+// the flag when it picks, so the caller must hold CPU id's
+// run queue lock and have queued the process that should run.
+static void
+resched(int id)
+{
+  cpus[id].resched = 1;
+  if(id != cpuid())
+    ipi(id);
+}
+
+// Has a wakeup asked this CPU's process to give up the CPU?
+int
+needresched(void)
+{
+  int r;
+
+  push_off();
+  r = mycpu()->resched;
+  pop_off();
+  return r;
+}
+
+// Should p, just queued on rq, take the CPU from cur, the
+// process running on rq's CPU? A higher class always does.
+// Caller must hold rq->lock.
+static int
+preempts(struct runq *rq, struct proc *p, struct proc *cur)
+{
+  struct schedpolicy *pol;
+
+  if(cur == 0 || cur == p)
+    return 0;
+  if(p->rqclass != cur->rqclass)
+    return p->rqclass < cur->rqclass;
+  pol = classof(rq, p->rqclass);
+  return pol->preempt && pol->preempt(p, cur);
+}
+
+// The latency histogram bucket of d cycles.
+static int
+latbucket(uint64 d)
+{
+  int b = 0;
+
+  if(d == 0)
+    return 0;
+  if(d >> 32){ b += 32; d >>= 32; }
+  if(d >> 16){ b += 16; d >>= 16; }
+  if(d >> 8){ b += 8; d >>= 8; }
+  if(d >> 4){ b += 4; d >>= 4; }
+  if(d >> 2){ b += 2; d >>= 2; }
+  if(d >> 1){ b += 1; }
+  b++;
+  return b < NLATBUCKET ? b : NLATBUCKET - 1;
+}
+
+// Count a delay of d cycles of kind (LAT_*) for p, under the
+// policy p was queued under, on this CPU.
+// Interrupts must be disabled.
+static void
+latnote(struct proc *p, int kind, uint64 d)
+{
+  int id = schedid(p);
+
+  if(id >= 0)
+    lat.count[cpuid()][id][kind][latbucket(d)]++;
+}
+
+// scheduler() is about to run p, which has been RUNNABLE
+// since p->stamp.
+// Caller must hold p->lock.
+void
+runqstart(struct proc *p)
+{
+  uint64 d = r_time() - p->stamp;
+
+  latnote(p, LAT_QUEUE, d);
+  if(p->woken){
+    latnote(p, LAT_WAKEUP, d);
+    p->woken = 0;
+  }
+  // p starts a new quantum, so its LOTTERY compensation ends.
+  p->used = 0;
+}
+
+// Copy the latency histograms to the struct schedlat at addr.
+int
+schedlat(uint64 addr)
+{
+  return copyout(myproc()->pagetable, addr, (char*)&lat, sizeof(lat));
+}
+
+// Mark a SLEEPING or new process RUNNABLE and put it on the
+// run queue of the CPU it last ran on, preempting the process
+// running there if p should go first. A CPU that is between
+// processes is checked against the process it has picked to
+// run next, if any; if it hasn't picked yet, its pick will
+// see p.
+// Caller must hold p->lock.
+void
+setrunnable(struct proc *p)
+{
+  struct runq *rq = &runqs[p->cpu];
+  struct cpu *c = &cpus[p->cpu];
+  struct proc *cur;
+  int preempt;
+
+  if(!holding(&p->lock))
+    panic("setrunnable");
+  if(p->rq || p->state == RUNNING || p->state == RUNNABLE)
+    panic("setrunnable queued");
+
+  p->woken = p->state == SLEEPING;
+  setstate(p, RUNNABLE);
+  activate(p);
+  acquire(&rq->lock);
+  rqenqueue(rq, p, 1);
+  if((cur = c->proc) == 0)
+    cur = c->picked;
+  preempt = preempts(rq, p, cur);
+  if(preempt)
+    resched(p->cpu);
+  release(&rq->lock);
+  if(!preempt)
+    kick(p->cpu);
+}
+
+// scheduler() has just switched away from p, which ran for
+// ran cycles on this CPU. The time is charged by the class it
+// ran in, or for the normal class by the policy it ran under.
+// If p yielded or was preempted, put it back on
+// this CPU's run queue; if it is SLEEPING or a ZOMBIE, it
+// stops competing for the CPU.
+// Caller must hold p->lock.
+void
+runqdone(struct proc *p, uint64 ran)
+{
+  struct runq *rq = &runqs[p->cpu];
+  struct schedpolicy *pol;
+  int n;
+
+  if(!holding(&p->lock))
+    panic("runqdone");
+  mycpu()->picked = 0;
+
+  if(p->rqclass != CLASS_NORMAL)
+    pol = classof(rq, p->rqclass);
+  else
+    pol = p->policy;
+  if(pol && pol->charge)
+    pol->charge(p, ran);
+  latnote(p, LAT_SLICE, ran);
+
+  if(p->state == RUNNABLE){
+    acquire(&rq->lock);
+    rqenqueue(rq, p, 0);
+    n = rq->n;
+    release(&rq->lock);
+    // this CPU will take one; let an idle one steal the rest.
+    if(n > 1)
+      kick(p->cpu);
+  } else {
+    deactivate(p);
+  }
+}
+
+// p's priority or tickets have changed; if it is queued,
+// queue it again so that its policy sees the change.
+// Caller must hold p->lock.
+void
+runqrequeue(struct proc *p)
+{
+  struct runq *rq = p->rq;
+
+  if(!holding(&p->lock))
+    panic("runqrequeue");
+  if(isactive(p)){
+    deactivate(p);
+    activate(p);
+  }
+  if(rq == 0)
+    return;
+
+  // A concurrent runqget() may take p off rq, but since we
+  // hold p->lock nobody can put it back on a queue.
+  acquire(&rq->lock);
+  if(p->rq == rq){
+    rqdequeue(rq, p);
+    rqenqueue(rq, p, 0);
+  }
+  release(&rq->lock);
+}
+
+// Take the next process to run off this CPU's run queue.
+// If it is empty, steal from the CPU with the most queued
+// processes. Returns 0 if nothing is runnable anywhere.
+// The process's lock is not held on return.
+struct proc*
+runqget(void)
+{
+  struct runq *rq, *victim;
+  struct proc *p;
+  int id, i, n, most;
+
+  push_off();
+  id = cpuid();
+  pop_off();
+
+  // a resched asked for before this pick is answered by it;
+  // one asked for after is for whatever this CPU runs next.
+  rq = &runqs[id];
+  acquire(&rq->lock);
+  cpus[id].resched = 0;
+  p = rqpick(rq);
+  cpus[id].picked = p;
+  release(&rq->lock);
+  if(p)
+    return p;
+
+  // Steal. rq->n is read without the lock just to choose a
+  // victim; rqpick() re-checks under the victim's lock.
+  victim = 0;
+  most = 0;
+  for(i = 1; i < NCPU; i++){
+    rq = &runqs[(id + i) % NCPU];
+    n = rq->n;
+    if(n > most){
+      most = n;
+      victim = rq;
+    }
+  }
+  if(victim == 0)
+    return 0;
+
+  acquire(&victim->lock);
+  p = rqpick(victim);
+  if(p && p->rqclass == CLASS_NORMAL && victim->policy->steal)
+    victim->policy->steal(victim, &runqs[id], p);
+  release(&victim->lock);
+  if(p){
+    cpus[id].picked = p;
+    TRACE(TRACE_MIGRATE, p->pid, victim - runqs, id);
+  }
+  return p;
+}
+
+// Called by scheduler() with interrupts off when runqget()
+// found nothing to run. Wait for an interrupt: kick() from a
+// CPU that queued work, a device, or, on CPU 0 only, the
+// timer. Other CPUs stop their timer while idle, so an idle
+// system only takes CPU 0's ticks.
+void
+runqidle(void)
+{
+  struct cpu *c = mycpu();
+  int id = cpuid();
+  uint64 t0;
+  int i;
+
+  c->idle = 1;
+  // pairs with the barrier in kick(), so work queued before
+  // the other CPU saw c->idle is seen by the check below.
+  __sync_synchronize();
+  for(i = 0; i < NCPU; i++)
+    if(runqs[i].n > 0)
+      break;
+  if(i == NCPU){
+    t0 = r_time();
+    c->idlestart = t0;
+    if(id != 0)
+      w_stimecmp(-1);
+    // returns when an interrupt is pending, even though
+    // interrupts are off; scheduler() takes it once it
+    // turns them back on.
+    wfi();
+    c->idletime += r_time() - t0;
+    c->idlestart = 0;
+    if(id != 0)
+      w_stimecmp(r_time() + QUANTUM);
+  }
+  c->idle = 0;
+}
+
+// The timer went off while p was running on this CPU.
+// Returns 1 if p should yield: a higher class than the one p
+// runs in has a process queued, or p's class says so.
+int
+schedtick(struct proc *p)
+{
+  struct runq *rq = &runqs[p->cpu];
+  struct schedpolicy *pol = p->policy;
+  int c;
+
+  dlcheck(p);
+  for(c = 0; c < p->rqclass; c++)
+    if(rq->nclass[c] > 0)
+      return 1;
+  if(p->rqclass != CLASS_NORMAL)
+    return classof(rq, p->rqclass)->tick(rq, p);
+  if(pol == 0)
+    pol = policies[curpolicy];
+  return pol->tick(rq, p);
+}
+
+// The priority a new process starts with.
+int
+schedprio(void)
+{
+  return policies[curpolicy]->prio;
+}
+
+// The id of the policy p was last queued under, or -1.
+int
+schedid(struct proc *p)
+{
+  int id;
+
+  for(id = 0; id < NELEM(policies); id++)
+    if(policies[id] == p->policy)
+      return id;
+  return -1;
+}
+
+// Switch every run queue to policy id. Each queued process is
+// taken off in the order the old policy would have run it and
+// queued again under the new one; processes that are running,
+// or on their way on or off a CPU, move over the next time
+// they are queued. id -1 just asks for the current policy.
+// Returns the previous policy, or -1 if id is not a policy.
+int
+setsched(int id)
+{
+  struct runq *rq;
+  struct proc *p, *head, *tail;
+  int old;
+
+  if(id != -1 && (id < 0 || id >= NELEM(policies)))
+    return -1;
+
+  acquire(&schedlock);
+  old = curpolicy;
+  if(id == -1 || id == old){
+    release(&schedlock);
+    return old;
+  }
+  curpolicy = id;
+
+  for(rq = runqs; rq < &runqs[NCPU]; rq++){
+    acquire(&rq->lock);
+    // rqnext is free once p is off the queue, so it
+    // chains the drained processes.
+    head = tail = 0;
+    while((p = rqpick(rq)) != 0){
+      p->rqnext = 0;
+      if(tail)
+        tail->rqnext = p;
+      else
+        head = p;
+      tail = p;
+    }
+    rq->policy = policies[id];
+    release(&rq->lock);
+    if(head == 0)
+      continue;
+
+    // queueing reads and updates p's scheduling fields, so
+    // it needs p->lock, which can't be taken under rq->lock.
+    // The drained processes are RUNNABLE but on no queue, so
+    // nothing else queues them meanwhile.
+    while((p = head) != 0){
+      head = p->rqnext;
+      acquire(&p->lock);
+      acquire(&rq->lock);
+      rqenqueue(rq, p, 0);
+      release(&rq->lock);
+      release(&p->lock);
+    }
+    // rq's CPU may have gone idle while rq was empty.
+    push_off();
+    kick(rq - runqs);
+    pop_off();
+  }
+  release(&schedlock);
+  return old;
+}
@@ -0,0 +1,139 @@
+// Scheduling policies and the per-CPU run queues they order.
+// See sched.c.
+
+#define NLEVEL 20              // FIFO levels, one per priority 1..20
+
+struct level {
+  struct proc *head;           // Oldest queued process
+  struct proc *tail;           // Newest queued process
+};
+
+// Min-heap of processes on p->rqkey, then p->rqseq.
+struct heap {
+  struct proc *p[NPROC];       // p[0] has the smallest key
+  int n;
+  uint64 seq;                  // Insertion counter, breaks ties FIFO
+};
+
+struct runq {
+  struct spinlock lock;
+  struct schedpolicy *policy;  // Policy ordering this queue
+  int n;                       // Number of queued processes
+  int nclass[NCLASS];          // How many of them are in each class
+
+  // Classes other than CLASS_NORMAL; see runq.c.
+  struct heap dl;              // CLASS_DEADLINE, on deadline
+  struct heap rt;              // CLASS_RT, on real-time priority
+  struct heap idle;            // CLASS_IDLE, FIFO
+
+  // The policies' structures, for CLASS_NORMAL.
+
+  // FIFO levels: DEFAULT, PRIORITY, SML, LOTTERY, MLFQ.
+  struct level lv[NLEVEL];
+  uint bitmap;                 // Bit i is set iff lv[i] is non-empty
+
+  // FCFS, STRIDE, SRTF
+  struct heap heap;
+
+  // LOTTERY
+  int tix[NPROC+1];            // Fenwick tree of queued tickets, 1-based
+  int total;                   // Sum of queued tickets
+
+  // STRIDE
+  uint64 pass;                 // Pass of the last process picked
+
+  // FAIR
+  struct rbtree tree;          // Queued processes ordered by vruntime
+  uint64 minvruntime;          // Never decreases
+
+  // MLFQ
+  uint epoch;                  // Boost period the levels were last reset in
+};
+
+// A scheduling policy, or a scheduling class other than the
+// normal one. Hooks that take a run queue are called with its
+// lock held, and p->lock may not be held, except for tick().
+// charge() is called with p->lock held. tick() is called by p
+// itself on its own CPU with no locks held, and may only peek
+// at rq. Hooks may be 0 where noted.
+struct schedpolicy {
+  int prio;                    // Priority of new processes
+
+  // Add p to or remove it from rq's structures.
+  void (*enqueue)(struct runq*, struct proc*);
+  void (*dequeue)(struct runq*, struct proc*);
+
+  // The queued process to run next; the caller dequeues it.
+  struct proc *(*pick_next)(struct runq*);
+
+  // The timer went off while p was running on the CPU of rq.
+  // Returns 1 if p should give up the CPU.
+  int (*tick)(struct runq*, struct proc*);
+
+  // p is about to be queued on rq after waking up, being
+  // created, or coming from another policy. May be 0.
+  void (*on_wakeup)(struct runq*, struct proc*);
+
+  // p has stopped running after ran cycles. May be 0.
+  void (*charge)(struct proc*, uint64);
+
+  // p has just been queued on rq; should it take the CPU from
+  // cur, which runs there in the same class? cur's fields are
+  // read without its lock. May be 0 for policies with no order
+  // to preempt by (round robin, FCFS, lottery) or, as in
+  // stride, where a waking process can't be ahead of cur.
+  int (*preempt)(struct proc*, struct proc*);
+
+  // p was picked from victim to run on the CPU of rq. Called
+  // with only victim's lock held. May be 0.
+  void (*steal)(struct runq*, struct runq*, struct proc*);
+};
+
+// runq.c
+void            levelpush(struct runq*, struct proc*, int);
+void            levelremove(struct runq*, struct proc*);
+struct proc*    levelfirst(struct runq*);
+void            heapinsert(struct heap*, struct proc*);
+void            heapremove(struct heap*, struct proc*);
+int             alwaystick(struct runq*, struct proc*);
+void            rqenqueue(struct runq*, struct proc*, int);
+void            rqdequeue(struct runq*, struct proc*);
+struct proc*    rqpick(struct runq*);
+struct schedpolicy* classof(struct runq*, int);
+
+// sched_deadline.c
+extern struct schedpolicy dlclass;
+void            dlinit(void);
+void            dlcheck(struct proc*);
+int             dlactive(struct proc*);
+
+// sched_class.c
+extern struct schedpolicy rtclass;
+extern struct schedpolicy idleclass;
+
+// sched_fifo.c
+extern struct schedpolicy rrpolicy;
+extern struct schedpolicy fcfspolicy;
+
+// sched_prio.c
+extern struct schedpolicy priopolicy;
+extern struct schedpolicy smlpolicy;
+
+// sched_lottery.c
+extern struct schedpolicy lotterypolicy;
+void            lotteryinit(void);
+int             isactive(struct proc*);
+void            activate(struct proc*);
+void            deactivate(struct proc*);
+
+// sched_stride.c
+extern struct schedpolicy stridepolicy;
+
+// sched_fair.c
+extern struct schedpolicy fairpolicy;
+
+// sched_mlfq.c
+extern struct schedpolicy mlfqpolicy;
+
+// sched_srtf.c
+extern struct schedpolicy srtfpolicy;
@@ -0,0 +1,106 @@
+// The real-time and idle scheduling classes, which sit above
+// and below the normal class in the class stack (see runq.c).
+//
+// RT runs the queued process with the best real-time priority,
+// 1 being the best, and takes turns a tick at a time among
+// processes of the same priority, like SCHED_RR. A process of
+// a better priority never waits for a worse one, and nothing
+// in the normal or idle classes runs while an RT process is
+// runnable, so RT processes must sleep now and then.
+//
+// IDLE is for batch and background work. Its processes run
+// only when no deadline, RT or normal process is runnable on
+// their CPU, first come first served, each for IDLEQUANTUM
+// ticks at a time so that they switch seldom.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+#define IDLEQUANTUM 10         // Ticks an idle process runs before the next
+
+static void
+rtenqueue(struct runq *rq, struct proc *p)
+{
+  p->rqkey = p->rtprio;
+  heapinsert(&rq->rt, p);
+}
+
+static void
+rtdequeue(struct runq *rq, struct proc *p)
+{
+  heapremove(&rq->rt, p);
+}
+
+static struct proc*
+rtpick(struct runq *rq)
+{
+  return rq->rt.p[0];
+}
+
+// Take turns with processes of the same priority.
+static int
+rttick(struct runq *rq, struct proc *p)
+{
+  return rq->rt.n > 0 && rq->rt.p[0]->rqkey <= p->rtprio;
+}
+
+static int
+rtpreempt(struct proc *p, struct proc *cur)
+{
+  return p->rtprio < cur->rtprio;
+}
+
+struct schedpolicy rtclass = {
+  .enqueue = rtenqueue,
+  .dequeue = rtdequeue,
+  .pick_next = rtpick,
+  .tick = rttick,
+  .preempt = rtpreempt,
+};
+
+static void
+idleenqueue(struct runq *rq, struct proc *p)
+{
+  p->rqkey = 0;
+  heapinsert(&rq->idle, p);
+}
+
+static void
+idledequeue(struct runq *rq, struct proc *p)
+{
+  heapremove(&rq->idle, p);
+}
+
+static struct proc*
+idlepick(struct runq *rq)
+{
+  return rq->idle.p[0];
+}
+
+static int
+idletick(struct runq *rq, struct proc *p)
+{
+  return ++p->idleticks >= IDLEQUANTUM && rq->idle.n > 0;
+}
+
+static void
+idlecharge(struct proc *p, uint64 ran)
+{
+  p->idleticks = 0;
+}
+
+struct schedpolicy idleclass = {
+  .enqueue = idleenqueue,
+  .dequeue = idledequeue,
+  .pick_next = idlepick,
+  .tick = idletick,
+  .charge = idlecharge,
+};
@@ -0,0 +1,199 @@
+// Earliest deadline first, for periodic real-time processes.
+//
+// A deadline process asks with sched_deadline() for runtime
+// ticks of CPU every period ticks, each within deadline ticks
+// of the start of its period. Each period releases a job with
+// a fresh budget of runtime and an absolute deadline; the job
+// ends when the process calls yield(), which sleeps until the
+// next release (see sys_yield()), and it has missed if it is
+// not done by then.
+//
+// A deadline process whose job has budget left is in the
+// deadline class, the first in the class stack (see runq.c),
+// and goes on its run queue's deadline heap, keyed on the
+// job's deadline, so it runs ahead of every other process. It
+// is preempted at the next tick when an earlier deadline is
+// queued. A job that uses up its budget or misses its deadline
+// drops to the process's own class until its next release, so
+// an overrunning process can't steal time the others were
+// promised.
+//
+// Admission control keeps the density, runtime / deadline,
+// of all deadline processes within one CPU. That is their
+// utilization when deadline equals period, and it bounds it
+// otherwise, so EDF meets every deadline even if all of them
+// end up on the same CPU, give or take a tick of latency.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+#define DLSCALE (1 << 20)      // Bandwidth of a whole CPU
+
+static struct spinlock dllock;
+static uint64 dltotal;         // Bandwidth reserved by all deadline processes
+
+void
+dlinit(void)
+{
+  initlock(&dllock, "deadline");
+}
+
+// Start p's next job at tick t.
+static void
+dlrelease(struct proc *p, uint t)
+{
+  p->dlnext = t + p->dlperiod;
+  p->dldead = t + p->dldeadline;
+  p->dlleft = (uint64)p->dlruntime * QUANTUM;
+  p->dlover = 0;
+  p->dlticks = 0;
+}
+
+// Bring p's job up to date with ticks: count a miss if it is
+// past its deadline, and release the next job if it is due.
+void
+dlcheck(struct proc *p)
+{
+  if(p->dlperiod == 0)
+    return;
+  if(!p->dlover && ticks >= p->dldead){
+    p->dlmisses++;
+    p->dlover = 1;
+  }
+  if(ticks >= p->dlnext)
+    dlrelease(p, ticks);
+}
+
+// Does p run as a deadline process right now?
+int
+dlactive(struct proc *p)
+{
+  return p->dlperiod && !p->dlover && p->dlleft > 0;
+}
+
+static void
+dlenqueue(struct runq *rq, struct proc *p)
+{
+  p->rqkey = p->dldead;
+  heapinsert(&rq->dl, p);
+}
+
+static void
+dldequeue(struct runq *rq, struct proc *p)
+{
+  heapremove(&rq->dl, p);
+}
+
+// The job with the earliest deadline.
+static struct proc*
+dlpick(struct runq *rq)
+{
+  return rq->dl.p[0];
+}
+
+// Returns 1 if p's job has missed its deadline or used its
+// budget, to a tick's precision, or if an earlier deadline is
+// queued.
+static int
+dltick(struct runq *rq, struct proc *p)
+{
+  dlcheck(p);
+  p->dlticks++;
+  if(!dlactive(p) || p->dlleft <= (uint64)p->dlticks * QUANTUM)
+    return 1;
+  return rq->dl.n > 0 && rq->dl.p[0]->rqkey < p->dldead;
+}
+
+static void
+dlcharge(struct proc *p, uint64 ran)
+{
+  p->dlticks = 0;
+  p->dlleft = ran < p->dlleft ? p->dlleft - ran : 0;
+}
+
+static int
+dlpreempt(struct proc *p, struct proc *cur)
+{
+  return p->dldead < cur->dldead;
+}
+
+struct schedpolicy dlclass = {
+  .enqueue = dlenqueue,
+  .dequeue = dldequeue,
+  .pick_next = dlpick,
+  .tick = dltick,
+  .charge = dlcharge,
+  .preempt = dlpreempt,
+};
+
+// Make p a deadline process with runtime, period and deadline
+// in ticks, or, if all three are 0, a normal process again.
+// Returns -1 if the parameters make no sense or the deadline
+// processes would need more than one CPU between them.
+// Caller must be p, holding p->lock.
+int
+dlset(struct proc *p, int runtime, int period, int deadline)
+{
+  uint64 bw;
+
+  if(runtime == 0 && period == 0 && deadline == 0){
+    dlleave(p);
+    return 0;
+  }
+  if(runtime < 1 || runtime > deadline || deadline > period)
+    return -1;
+
+  bw = (uint64)runtime * DLSCALE / deadline;
+  acquire(&dllock);
+  if(dltotal - p->dlbw + bw > DLSCALE){
+    release(&dllock);
+    return -1;
+  }
+  dltotal = dltotal - p->dlbw + bw;
+  release(&dllock);
+
+  p->dlbw = bw;
+  p->dlruntime = runtime;
+  p->dlperiod = period;
+  p->dldeadline = deadline;
+  dlrelease(p, ticks);
+  return 0;
+}
+
+// p is exiting or giving up its deadline; free its bandwidth.
+// Caller must hold p->lock.
+void
+dlleave(struct proc *p)
+{
+  acquire(&dllock);
+  dltotal -= p->dlbw;
+  release(&dllock);
+  p->dlbw = 0;
+  p->dlperiod = 0;
+}
+
+// p's current job is done. Returns the tick p's next job is
+// released at, which p should sleep until, or 0 if p is not a
+// deadline process or was so late that its next job is out.
+// Caller must be p, holding p->lock.
+uint
+dldone(struct proc *p)
+{
+  uint next = p->dlnext;
+
+  if(p->dlperiod == 0)
+    return 0;
+  dlcheck(p);
+  if(p->dlnext != next)
+    return 0;
+  p->dlover = 1;
+  return next;
+}
@@ -0,0 +1,126 @@
+// Weighted fair scheduling, like Linux's CFS.
+//
+// FAIR keeps the queued processes in a red-black tree ordered
+// by vruntime, the time each has run scaled by NICE0 / weight,
+// and runs the leftmost. The weight comes from a nice value of
+// priority - 10 through the Linux nice-to-weight table, so each
+// nice step is worth about 10% of the CPU. The run queue's
+// min_vruntime only moves forward; a waking process rejoins no
+// further than FAIRSLEEP behind it, so a long sleeper gets a
+// short boost rather than the CPU to itself, and a stolen
+// process keeps its distance behind min_vruntime as it moves
+// to the thief's queue. A waking process more than FAIRWAKEUP
+// behind the running one preempts it straight away.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "schedtab.h"
+#include "sched.h"
+#include "defs.h"
+
+#define FAIRSLEEP QUANTUM      // Most vruntime credit a waking process gets
+#define FAIRWAKEUP (QUANTUM / 10) // vruntime lead a waking process preempts with
+
+static const int weights[20] = FAIRWEIGHTS;
+
+// Tree node of each process slot; a process is on at most
+// one run queue's tree.
+static struct rbnode rbnodes[NPROC];
+
+static int
+weight(struct proc *p)
+{
+  int i = p->priority - 1;
+
+  if(i < 0)
+    i = 0;
+  if(i > 19)
+    i = 19;
+  return weights[i];
+}
+
+static struct proc*
+nodeproc(struct rbnode *n)
+{
+  return procs[n - rbnodes];
+}
+
+static int
+vless(struct rbnode *a, struct rbnode *b)
+{
+  return nodeproc(a)->vruntime < nodeproc(b)->vruntime;
+}
+
+static void
+fairenqueue(struct runq *rq, struct proc *p)
+{
+  rbinsert(&rq->tree, &rbnodes[p->slot], vless);
+}
+
+static void
+fairdequeue(struct runq *rq, struct proc *p)
+{
+  rberase(&rq->tree, &rbnodes[p->slot]);
+}
+
+// The process that has had the least weighted time.
+static struct proc*
+fairpick(struct runq *rq)
+{
+  struct proc *p = nodeproc(rq->tree.first);
+
+  if(p->vruntime > rq->minvruntime)
+    rq->minvruntime = p->vruntime;
+  return p;
+}
+
+static void
+fairwakeup(struct runq *rq, struct proc *p)
+{
+  if(p->vruntime + FAIRSLEEP < rq->minvruntime)
+    p->vruntime = rq->minvruntime - FAIRSLEEP;
+}
+
+static void
+faircharge(struct proc *p, uint64 ran)
+{
+  p->vruntime += ran * NICE0 / weight(p);
+}
+
+// cur's vruntime leaves out the slice under way, so this errs
+// on the side of letting cur run; FAIRWAKEUP keeps two
+// processes with about the same vruntime from ping-ponging.
+static int
+fairpreempt(struct proc *p, struct proc *cur)
+{
+  return p->vruntime + FAIRWAKEUP < cur->vruntime;
+}
+
+// fairpick() left p at or behind victim's min_vruntime;
+// keep it that far behind rq's.
+static void
+fairsteal(struct runq *victim, struct runq *rq, struct proc *p)
+{
+  uint64 lag = victim->minvruntime - p->vruntime;
+  uint64 min = rq->minvruntime;
+
+  p->vruntime = min > lag ? min - lag : 0;
+}
+
+struct schedpolicy fairpolicy = {
+  .prio = 10,
+  .enqueue = fairenqueue,
+  .dequeue = fairdequeue,
+  .pick_next = fairpick,
+  .tick = alwaystick,
+  .on_wakeup = fairwakeup,
+  .charge = faircharge,
+  .steal = fairsteal,
+  .preempt = fairpreempt,
+};
@@ -0,0 +1,80 @@
+// First-in, first-out policies.
+//
+// Round robin (DEFAULT) keeps every process on one FIFO level
+// and preempts it on every tick. First come, first served
+// (FCFS) keeps the queued processes in the run queue's heap,
+// keyed on creation time with the pid breaking ties, so the
+// oldest process runs first, and never preempts it: a process
+// keeps its CPU until it sleeps, yields or exits, which is the
+// fewest context switches a batch of jobs can take.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+static void
+fifoenqueue(struct runq *rq, struct proc *p)
+{
+  levelpush(rq, p, 0);
+}
+
+static void
+fifodequeue(struct runq *rq, struct proc *p)
+{
+  levelremove(rq, p);
+}
+
+static struct proc*
+rrpick(struct runq *rq)
+{
+  return levelfirst(rq);
+}
+
+static void
+fcfsenqueue(struct runq *rq, struct proc *p)
+{
+  p->rqkey = (uint64)p->ctime << 32 | (uint)p->pid;
+  heapinsert(&rq->heap, p);
+}
+
+static void
+fcfsdequeue(struct runq *rq, struct proc *p)
+{
+  heapremove(&rq->heap, p);
+}
+
+// The process that was created first.
+static struct proc*
+fcfspick(struct runq *rq)
+{
+  return rq->heap.p[0];
+}
+
+static int
+fcfstick(struct runq *rq, struct proc *p)
+{
+  return 0;
+}
+
+struct schedpolicy rrpolicy = {
+  .prio = 10,
+  .enqueue = fifoenqueue,
+  .dequeue = fifodequeue,
+  .pick_next = rrpick,
+  .tick = alwaystick,
+};
+
+struct schedpolicy fcfspolicy = {
+  .prio = 10,
+  .enqueue = fcfsenqueue,
+  .dequeue = fcfsdequeue,
+  .pick_next = fcfspick,
+  .tick = fcfstick,
+};
@@ -0,0 +1,340 @@
+// Lottery scheduling, after Waldspurger's paper (see
+// lab_scheduling/end/waldspurger.pdf).
+//
+// LOTTERY keeps a Fenwick tree of the tickets held by the
+// queued processes, indexed by process slot, so one draw from a
+// per-CPU generator finds the winner in O(log NPROC). What a
+// process counts for in the tree is the value of its tickets:
+//  - tickets in a currency are worth the currency's funding
+//    divided among the tickets of its active members;
+//  - a process that blocked after using only a fraction f of
+//    its quantum holds compensation tickets worth 1/f until it
+//    next runs;
+//  - a process blocked in wait() or on a pipe lends its value
+//    to the child or pipe peer it waits for (ticketlend()).
+// Values are computed when a process is queued, so a currency
+// whose active set changes revalues its other members as they
+// pass through the run queue. Queued processes also sit on
+// FIFO level 0, which is used when none of them hold tickets.
+//
+// Currency membership is kept up to date under every policy,
+// so that switching to LOTTERY finds it correct.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+// Most a process can count for, so that the values of all
+// NPROC slots still add up within rq->total.
+#define MAXVALUE (0x7fffffff / NPROC)
+
+// A currency funds its members with a pool of base tickets.
+struct currency {
+  int refs;                    // Number of member processes; free if 0
+  int funding;                 // Base tickets backing the currency
+  int active;                  // Tickets held by RUNNABLE or RUNNING members
+};
+
+// currencies[0] is the base currency and is never used.
+static struct currency currencies[NCURRENCY];
+static struct spinlock currencylock;
+
+void
+lotteryinit(void)
+{
+  int i;
+
+  initlock(&currencylock, "currency");
+
+  // Each CPU draws lottery tickets from its own generator.
+  // The seeds must be larger than 1, 7, 15 and 127.
+  for(i = 0; i < NCPU; i++){
+    cpus[i].rand[0] = 12345 + i;
+    cpus[i].rand[1] = 23456 + i;
+    cpus[i].rand[2] = 34567 + i;
+    cpus[i].rand[3] = 45678 + i;
+  }
+}
+
+// Add n tickets to process slot i.
+// Caller must hold rq->lock.
+static void
+tixadd(struct runq *rq, int i, int n)
+{
+  for(i++; i <= NPROC; i += i & -i)
+    rq->tix[i] += n;
+  rq->total += n;
+}
+
+// The process slot holding ticket number t, where
+// 0 <= t < rq->total: the smallest slot whose tickets
+// and those of the slots before it add up to more than t.
+// Caller must hold rq->lock.
+static int
+tixfind(struct runq *rq, int t)
+{
+  int i = 0, step;
+
+  for(step = 1; step * 2 <= NPROC; step *= 2)
+    ;
+  for(; step > 0; step >>= 1){
+    if(i + step <= NPROC && rq->tix[i + step] <= t){
+      i += step;
+      t -= rq->tix[i];
+    }
+  }
+  return i;
+}
+
+// What p's tickets are worth in base tickets: its own tickets
+// converted from its currency, inflated by its compensation
+// tickets if comp is set, plus whatever blocked processes lend
+// it, capped at MAXVALUE. Caller must hold p->lock.
+static int
+value(struct proc *p, int comp)
+{
+  struct currency *c;
+  uint64 v;
+
+  v = p->tickets > 0 ? p->tickets : 0;
+  if(p->currency){
+    // a racy read of c->active only makes the value stale.
+    c = &currencies[p->currency];
+    v = c->active > 0 ? v * c->funding / c->active : 0;
+  }
+  if(v > MAXVALUE)
+    v = MAXVALUE;
+  if(comp && p->used)
+    v = v * QUANTUM / p->used;
+  v += p->borrowed;
+  return v < MAXVALUE ? v : MAXVALUE;
+}
+
+// Return a pseudo-random number from this CPU's generator.
+// This is L'Ecuyer's four-component LFSR (lfsr113), the same
+// recurrence the old shared random() used, with unsigned
+// per-CPU state so concurrent draws on different harts don't
+// race. Interrupts must be disabled.
+static uint
+random(void)
+{
+  uint *z = mycpu()->rand;
+  uint b;
+
+  b = ((z[0] << 6) ^ z[0]) >> 13;
+  z[0] = ((z[0] & 4294967294U) << 18) ^ b;
+  b = ((z[1] << 2) ^ z[1]) >> 27;
+  z[1] = ((z[1] & 4294967288U) << 2) ^ b;
+  b = ((z[2] << 13) ^ z[2]) >> 21;
+  z[2] = ((z[2] & 4294967280U) << 7) ^ b;
+  b = ((z[3] << 3) ^ z[3]) >> 12;
+  z[3] = ((z[3] & 4294967168U) << 13) ^ b;
+  return z[0] ^ z[1] ^ z[2] ^ z[3];
+}
+
+static void
+lotteryenqueue(struct runq *rq, struct proc *p)
+{
+  levelpush(rq, p, 0);
+  p->rqtickets = value(p, 1);
+  tixadd(rq, p->slot, p->rqtickets);
+}
+
+static void
+lotterydequeue(struct runq *rq, struct proc *p)
+{
+  levelremove(rq, p);
+  tixadd(rq, p->slot, -p->rqtickets);
+}
+
+// Draw one ticket among all queued processes. If none of
+// them holds any tickets, fall back to round robin.
+static struct proc*
+lotterypick(struct runq *rq)
+{
+  struct proc *p;
+
+  if(rq->total > 0)
+    p = procs[tixfind(rq, random() % rq->total)];
+  else
+    p = levelfirst(rq);
+  return p;
+}
+
+// Blocking early earns compensation tickets worth
+// QUANTUM / ran, capped at 100 times p's value, until
+// runqstart() next dispatches p.
+static void
+lotterycharge(struct proc *p, uint64 ran)
+{
+  if(p->state == RUNNABLE)
+    return;
+  if(ran < QUANTUM / 100)
+    ran = QUANTUM / 100;
+  p->used = ran < QUANTUM ? ran : 0;
+}
+
+struct schedpolicy lotterypolicy = {
+  .prio = 10,
+  .enqueue = lotteryenqueue,
+  .dequeue = lotterydequeue,
+  .pick_next = lotterypick,
+  .tick = alwaystick,
+  .charge = lotterycharge,
+};
+
+// A process's tickets are active in its currency while it is
+// RUNNABLE or RUNNING. runqdone() deactivates them once p has
+// blocked or exited.
+int
+isactive(struct proc *p)
+{
+  return p->state == RUNNABLE || p->state == RUNNING;
+}
+
+// Caller must hold p->lock.
+void
+activate(struct proc *p)
+{
+  if(p->currency == 0)
+    return;
+  acquire(&currencylock);
+  p->curactive = p->tickets > 0 ? p->tickets : 0;
+  currencies[p->currency].active += p->curactive;
+  release(&currencylock);
+}
+
+// Caller must hold p->lock.
+void
+deactivate(struct proc *p)
+{
+  if(p->currency == 0)
+    return;
+  acquire(&currencylock);
+  currencies[p->currency].active -= p->curactive;
+  p->curactive = 0;
+  release(&currencylock);
+}
+
+// Move p out of its currency and into currency id.
+// Caller must hold p->lock and currencylock.
+static void
+joincurrency(struct proc *p, int id)
+{
+  struct currency *c;
+
+  if(p->currency){
+    c = &currencies[p->currency];
+    c->active -= p->curactive;
+    c->refs--;
+  }
+  p->curactive = 0;
+  p->currency = id;
+  if(id){
+    c = &currencies[id];
+    c->refs++;
+    if(isactive(p)){
+      p->curactive = p->tickets > 0 ? p->tickets : 0;
+      c->active += p->curactive;
+    }
+  }
+}
+
+// Move p into currency id, 0 being the base currency. A
+// currency is freed when its last member leaves it.
+// Returns -1 if id is not an allocated currency.
+// Caller must hold p->lock.
+int
+setcurrency(struct proc *p, int id)
+{
+  if(id < 0 || id >= NCURRENCY)
+    return -1;
+  acquire(&currencylock);
+  if(id != 0 && currencies[id].refs == 0){
+    release(&currencylock);
+    return -1;
+  }
+  joincurrency(p, id);
+  release(&currencylock);
+  runqrequeue(p);
+  return 0;
+}
+
+// Allocate a currency backed by funding base tickets and
+// move p into it. Returns its id, or -1 if none are free.
+// Caller must hold p->lock.
+int
+curralloc(struct proc *p, int funding)
+{
+  int id;
+
+  if(funding < 0)
+    return -1;
+  acquire(&currencylock);
+  for(id = 1; id < NCURRENCY; id++){
+    if(currencies[id].refs == 0){
+      currencies[id].funding = funding;
+      currencies[id].active = 0;
+      joincurrency(p, id);
+      release(&currencylock);
+      runqrequeue(p);
+      return id;
+    }
+  }
+  release(&currencylock);
+  return -1;
+}
+
+// p, which is about to sleep waiting for t, lends t what its
+// tickets are worth until ticketreturn(). tpid guards against
+// t's slot having been reused. A no-op unless p is
+// scheduled by LOTTERY.
+// Caller must not hold p->lock or t->lock.
+void
+ticketlend(struct proc *p, struct proc *t, int tpid)
+{
+  if(t == 0 || t == p)
+    return;
+  acquire(&p->lock);
+  if(p->policy != &lotterypolicy){
+    release(&p->lock);
+    return;
+  }
+  p->lent = value(p, 0);
+  release(&p->lock);
+
+  acquire(&t->lock);
+  if(t->pid == tpid && t->state != UNUSED && t->state != ZOMBIE){
+    t->borrowed += p->lent;
+    runqrequeue(t);
+    p->lendee = t;
+    p->lendpid = tpid;
+  }
+  release(&t->lock);
+}
+
+// p has woken up; take back what it lent.
+// Caller must not hold p->lock or p->lendee's lock.
+void
+ticketreturn(struct proc *p)
+{
+  struct proc *t = p->lendee;
+
+  if(t == 0)
+    return;
+  acquire(&t->lock);
+  if(t->pid == p->lendpid){
+    t->borrowed -= p->lent;
+    runqrequeue(t);
+  }
+  release(&t->lock);
+  p->lendee = 0;
+  p->lent = 0;
+}
@@ -0,0 +1,139 @@
+// Multilevel feedback queue, as in OSTEP chapter 8.
+//
+// MLFQ runs the oldest process on the highest non-empty level
+// (level 0 is the highest) and moves processes between levels
+// by how they use the CPU rather than by their priority:
+//  - a new process starts at level 0;
+//  - a process that has run for its level's whole allotment
+//    of ticks is preempted and moved down a level, and lower
+//    levels get longer allotments, so CPU hogs sink and run
+//    in longer slices;
+//  - a process that blocks keeps its level and what it has
+//    used of the allotment, so it can't stay on top by
+//    sleeping just before the allotment runs out;
+//  - a running process is preempted as soon as a process on
+//    a higher level wakes up on its CPU, or at the next tick
+//    once one is queued there;
+//  - every MLFQBOOST ticks all processes go back to level 0,
+//    so sunk processes don't starve and a process that turns
+//    interactive gets to rise again.
+// Boosting is lazy: a process whose mlfqepoch is stale is
+// treated as being at level 0, and the first pick from a run
+// queue in a new period moves its queued processes up.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+#define NMLFQ 4                // Levels
+#define MLFQBOOST 20           // Ticks between boosts
+
+// Allotment of level l, in ticks: 1, 2, 4, 8.
+static int
+allotment(int l)
+{
+  return 1 << l;
+}
+
+// The current boost period. ticks is read without tickslock;
+// a stale value only delays a boost by a tick.
+static uint
+epoch(void)
+{
+  return ticks / MLFQBOOST;
+}
+
+// Move p back to level 0 if a boost happened since it last
+// got a level.
+static void
+refresh(struct proc *p, uint e)
+{
+  if(p->mlfqepoch != e){
+    p->mlfqepoch = e;
+    p->mlfqlevel = 0;
+    p->mlfqticks = 0;
+  }
+}
+
+static void
+mlfqenqueue(struct runq *rq, struct proc *p)
+{
+  refresh(p, epoch());
+  levelpush(rq, p, p->mlfqlevel);
+}
+
+static void
+mlfqdequeue(struct runq *rq, struct proc *p)
+{
+  levelremove(rq, p);
+}
+
+// Boost: move everything queued on the lower levels to the
+// tail of level 0, highest level first.
+static void
+boost(struct runq *rq, uint e)
+{
+  struct proc *p;
+  int l;
+
+  for(l = 1; l < NMLFQ; l++){
+    while((p = rq->lv[l].head) != 0){
+      levelremove(rq, p);
+      refresh(p, e);
+      levelpush(rq, p, 0);
+    }
+  }
+  rq->epoch = e;
+}
+
+static struct proc*
+mlfqpick(struct runq *rq)
+{
+  uint e = epoch();
+
+  if(rq->epoch != e)
+    boost(rq, e);
+  return levelfirst(rq);
+}
+
+// Charge p a tick. Preempt it if it has used up its level's
+// allotment, demoting it, or if a process on a higher level
+// is waiting.
+static int
+mlfqtick(struct runq *rq, struct proc *p)
+{
+  refresh(p, epoch());
+  if(++p->mlfqticks >= allotment(p->mlfqlevel)){
+    if(p->mlfqlevel < NMLFQ - 1)
+      p->mlfqlevel++;
+    p->mlfqticks = 0;
+    return 1;
+  }
+  return (rq->bitmap & ((1 << p->mlfqlevel) - 1)) != 0;
+}
+
+// cur's level is read without its lock, so a stale epoch is
+// only taken into account, not refreshed.
+static int
+mlfqpreempt(struct proc *p, struct proc *cur)
+{
+  int l = cur->mlfqepoch == epoch() ? cur->mlfqlevel : 0;
+
+  return p->mlfqlevel < l;
+}
+
+struct schedpolicy mlfqpolicy = {
+  .prio = 10,
+  .enqueue = mlfqenqueue,
+  .dequeue = mlfqdequeue,
+  .pick_next = mlfqpick,
+  .tick = mlfqtick,
+  .preempt = mlfqpreempt,
+};
@@ -0,0 +1,77 @@
+// Static priority policies. PRIORITY (20 levels) and SML
+// (3 levels) queue a process at the level of its priority,
+// so the next process is the oldest one on the lowest
+// non-empty level and equal priorities go round robin.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+// p's priority, clamped to levels 0..n-1.
+static int
+level(struct proc *p, int n)
+{
+  int l = p->priority - 1;
+
+  if(l < 0)
+    l = 0;
+  if(l >= n)
+    l = n - 1;
+  return l;
+}
+
+static void
+prioenqueue(struct runq *rq, struct proc *p)
+{
+  levelpush(rq, p, level(p, 20));
+}
+
+static void
+smlenqueue(struct runq *rq, struct proc *p)
+{
+  levelpush(rq, p, level(p, 3));
+}
+
+// A better priority takes the CPU as soon as it wakes up.
+static int
+priopreempt(struct proc *p, struct proc *cur)
+{
+  return level(p, 20) < level(cur, 20);
+}
+
+static int
+smlpreempt(struct proc *p, struct proc *cur)
+{
+  return level(p, 3) < level(cur, 3);
+}
+
+static void
+priodequeue(struct runq *rq, struct proc *p)
+{
+  levelremove(rq, p);
+}
+
+struct schedpolicy priopolicy = {
+  .prio = 10,
+  .enqueue = prioenqueue,
+  .dequeue = priodequeue,
+  .pick_next = levelfirst,
+  .tick = alwaystick,
+  .preempt = priopreempt,
+};
+
+struct schedpolicy smlpolicy = {
+  .prio = 2,
+  .enqueue = smlenqueue,
+  .dequeue = priodequeue,
+  .pick_next = levelfirst,
+  .tick = alwaystick,
+  .preempt = smlpreempt,
+};
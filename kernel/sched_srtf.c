@@ -0,0 +1,116 @@
+// Shortest remaining time first, with predicted bursts.
+//
+// SRTF keeps the queued processes in the run queue's heap,
+// keyed on how much of its predicted CPU burst each has left,
+// and runs the one with the least. A burst is the CPU time a
+// process uses between waking up and blocking; its prediction
+// is an exponential average of the process's past bursts,
+//   predict = (predict + burst) / 2,
+// updated when the process stops running, i.e. goes RUNNING
+// to SLEEPING or to RUNNABLE:
+//  - a process that blocks has finished its burst;
+//  - a process that is preempted or yields before reaching
+//    its prediction goes on with the same burst, with less of
+//    it left;
+//  - a process that is still running past its prediction has
+//    its burst so far counted as a finished one, so a CPU hog's
+//    prediction grows to about a tick and it takes turns with
+//    other hogs instead of monopolizing the CPU.
+// The running process is preempted as soon as a process with
+// less left than it wakes up on its CPU, and otherwise at the
+// next tick once a queued process has less left than it does,
+// or once it has run past its prediction while others wait.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+#define SRTFINIT (QUANTUM / 10)  // Prediction for a process's first burst
+
+// Cycles left of p's predicted burst, having run done of it.
+static uint64
+remaining(struct proc *p, uint64 done)
+{
+  return p->predict > done ? p->predict - done : 0;
+}
+
+// Cycles p has run of its current burst, counting the slice
+// under way only to a tick's precision.
+static uint64
+burstdone(struct proc *p)
+{
+  return p->burstran + (uint64)p->srtfticks * QUANTUM;
+}
+
+static void
+srtfenqueue(struct runq *rq, struct proc *p)
+{
+  if(p->predict == 0)
+    p->predict = SRTFINIT;
+  p->rqkey = remaining(p, p->burstran);
+  heapinsert(&rq->heap, p);
+}
+
+static void
+srtfdequeue(struct runq *rq, struct proc *p)
+{
+  heapremove(&rq->heap, p);
+}
+
+// The process with the least of its burst left.
+static struct proc*
+srtfpick(struct runq *rq)
+{
+  return rq->heap.p[0];
+}
+
+static int
+srtftick(struct runq *rq, struct proc *p)
+{
+  uint64 done;
+
+  p->srtfticks++;
+  if(rq->heap.n == 0)
+    return 0;
+  done = burstdone(p);
+  if(done >= p->predict)
+    return 1;
+  return rq->heap.p[0]->rqkey < remaining(p, done);
+}
+
+// p, just woken, has less of its burst left than cur.
+static int
+srtfpreempt(struct proc *p, struct proc *cur)
+{
+  return remaining(p, p->burstran) < remaining(cur, burstdone(cur));
+}
+
+static void
+srtfcharge(struct proc *p, uint64 ran)
+{
+  p->srtfticks = 0;
+  p->burstran += ran;
+  if(p->state == RUNNABLE && p->burstran < p->predict)
+    return;
+  p->predict = (p->predict + p->burstran) / 2;
+  if(p->predict == 0)
+    p->predict = 1;
+  p->burstran = 0;
+}
+
+struct schedpolicy srtfpolicy = {
+  .prio = 10,
+  .enqueue = srtfenqueue,
+  .dequeue = srtfdequeue,
+  .pick_next = srtfpick,
+  .tick = srtftick,
+  .charge = srtfcharge,
+  .preempt = srtfpreempt,
+};
@@ -0,0 +1,67 @@
+// Stride scheduling.
+//
+// STRIDE keeps the queued processes in the run queue's heap,
+// keyed on pass. A process's stride is STRIDE1 / tickets, and
+// each time it stops running it is charged its stride times
+// the fraction of a quantum it used. The run queue's pass is
+// the pass of the last process picked from it, and a process
+// rejoins the queue at that pass plus what it was charged, so
+// sleepers can't bank credit.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "rbtree.h"
+#include "policy.h"
+#include "sched.h"
+#include "defs.h"
+
+#define STRIDE1 (1 << 20)      // Stride of a process with one ticket
+
+// How far p's pass advances per quantum it uses.
+static uint64
+stride(struct proc *p)
+{
+  return STRIDE1 / (p->tickets > 0 ? p->tickets : 1);
+}
+
+static void
+strideenqueue(struct runq *rq, struct proc *p)
+{
+  p->rqkey = rq->pass + p->remain;
+  heapinsert(&rq->heap, p);
+}
+
+static void
+stridedequeue(struct runq *rq, struct proc *p)
+{
+  heapremove(&rq->heap, p);
+}
+
+// The process with the smallest pass.
+static struct proc*
+stridepick(struct runq *rq)
+{
+  struct proc *p = rq->heap.p[0];
+
+  rq->pass = p->rqkey;
+  return p;
+}
+
+static void
+stridecharge(struct proc *p, uint64 ran)
+{
+  p->remain = stride(p) * ran / QUANTUM;
+}
+
+struct schedpolicy stridepolicy = {
+  .prio = 10,
+  .enqueue = strideenqueue,
+  .dequeue = stridedequeue,
+  .pick_next = stridepick,
+  .tick = alwaystick,
+  .charge = stridecharge,
+};
@@ -0,0 +1,14 @@
+// Scheduler latency histograms, as reported by schedlat().
+// Bucket 0 counts delays of 0 cycles and bucket b > 0 those of
+// 2^(b-1) to 2^b - 1 cycles; the last bucket counts the rest.
+#define NLATBUCKET 40
+
+#define LAT_QUEUE   0          // RUNNABLE to RUNNING
+#define LAT_WAKEUP  1          // Woken up to first run
+#define LAT_SLICE   2          // Time run before giving up the CPU
+#define NLAT        3
+
+struct schedlat {
+  // By CPU run on and policy run under (see policy.h).
+  uint count[NCPU][NSCHED][NLAT][NLATBUCKET];
+};
@@ -0,0 +1,25 @@
+// Tables about the scheduling policies in policy.h, shared by
+// the kernel, the user programs and sim so that they can't
+// drift apart. Each is an initializer, for a file to make its
+// own array from: static char *names[] = SCHEDNAMES;
+
+// Names of the policies, indexed by SCHED_ number.
+#define SCHEDNAMES { \
+  [SCHED_DEFAULT]  "default", \
+  [SCHED_PRIORITY] "priority", \
+  [SCHED_FCFS]     "fcfs", \
+  [SCHED_LOTTERY]  "lottery", \
+  [SCHED_SML]      "sml", \
+  [SCHED_STRIDE]   "stride", \
+  [SCHED_FAIR]     "fair", \
+  [SCHED_MLFQ]     "mlfq", \
+  [SCHED_SRTF]     "srtf", \
+}
+
+// FAIR's weights for priorities 1 to 20: Linux's
+// sched_prio_to_weight[] for nice -9 to 10.
+#define NICE0 1024             // Weight of priority 10 (nice 0)
+#define FAIRWEIGHTS { \
+  7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277, 1024, \
+  820, 655, 526, 423, 335, 272, 215, 172, 137, 110, \
+}
@@ -6,10 +6,17 @@
 
 void main();
 void timerinit();
+void ipiinit();
 
 // entry.S needs one stack per CPU.
 __attribute__ ((aligned (16))) char stack0[4096 * NCPU];
 
+// scratch area for machinevec in kernelvec.S, one per CPU.
+uint64 mscratch0[NCPU * 3];
+
+// in kernelvec.S, handles machine-mode software interrupts.
+extern void machinevec();
+
 // entry.S jumps here in machine mode on stack0.
 /**
  * @brief entry.S 在机器模式跳转到 stack0,跳转到 start 函数，
@@ -44,6 +51,9 @@ void start()
     // ask for clock interrupts.
     timerinit();
 
+    // let other harts wake this one.
+    ipiinit();
+
     // keep each CPU's hartid in its tp register, for cpuid().
     int id = r_mhartid();
     w_tp(id);
@@ -65,5 +75,18 @@ void timerinit()
     w_mcounteren(r_mcounteren() | 2);
 
     // ask for the very first timer interrupt.
-    w_stimecmp(r_time() + 1000000);
+    w_stimecmp(r_time() + QUANTUM);
+}
+
+// take machine software interrupts, which other harts send
+// through the CLINT to wake this one, in machinevec.
+void ipiinit()
+{
+    int id = r_mhartid();
+    uint64 *scratch = &mscratch0[3 * id];
+
+    scratch[2] = CLINT_MSIP(id);
+    w_mscratch((uint64)scratch);
+    w_mtvec((uint64)machinevec);
+    w_mie(r_mie() | MIE_MSIE);
 }
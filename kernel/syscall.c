@@ -101,12 +101,23 @@ extern uint64 sys_unlink(void);
 extern uint64 sys_link(void);
 extern uint64 sys_mkdir(void);
 extern uint64 sys_close(void);
-extern uint64 sys_getptable(void);
+extern uint64 sys_procstat(void);
 extern uint64 sys_getppid(void);
 extern uint64 sys_chpr(void);
 extern uint64 sys_wait2(void);
 extern uint64 sys_yield(void);
 extern uint64 sys_chtickets(void);
+extern uint64 sys_mkcurrency(void);
+extern uint64 sys_chcurrency(void);
+extern uint64 sys_setsched(void);
+extern uint64 sys_idlestat(void);
+extern uint64 sys_waitpid(void);
+extern uint64 sys_schedlat(void);
+extern uint64 sys_settrace(void);
+extern uint64 sys_traceread(void);
+extern uint64 sys_sched_deadline(void);
+extern uint64 sys_setclass(void);
+extern uint64 sys_freemem(void);
 
 // An array mapping syscall numbers from syscall.h
 // to the function that handles the system call.
@@ -132,12 +143,23 @@ static uint64 (*syscalls[])(void) = {
 [SYS_link]    sys_link,
 [SYS_mkdir]   sys_mkdir,
 [SYS_close]   sys_close,
-[SYS_getptable] sys_getptable,
+[SYS_procstat] sys_procstat,
 [SYS_getppid] sys_getppid,
 [SYS_chpr]    sys_chpr,
 [SYS_wait2]    sys_wait2,
 [SYS_yield]    sys_yield,
 [SYS_chtickets]    sys_chtickets,
+[SYS_mkcurrency]   sys_mkcurrency,
+[SYS_chcurrency]   sys_chcurrency,
+[SYS_setsched]     sys_setsched,
+[SYS_idlestat]     sys_idlestat,
+[SYS_waitpid]      sys_waitpid,
+[SYS_schedlat]     sys_schedlat,
+[SYS_settrace]     sys_settrace,
+[SYS_traceread]    sys_traceread,
+[SYS_sched_deadline] sys_sched_deadline,
+[SYS_setclass]     sys_setclass,
+[SYS_freemem]      sys_freemem,
 };
 
 void
@@ -20,9 +20,20 @@
 #define SYS_link   19
 #define SYS_mkdir  20
 #define SYS_close  21
-#define SYS_getptable 22
+#define SYS_procstat 22
 #define SYS_getppid 23
 #define SYS_chpr   24
 #define SYS_wait2  25
 #define SYS_yield  26
 #define SYS_chtickets  27
+#define SYS_mkcurrency 28
+#define SYS_chcurrency 29
+#define SYS_setsched 30
+#define SYS_idlestat 31
+#define SYS_waitpid 32
+#define SYS_schedlat 33
+#define SYS_settrace 34
+#define SYS_traceread 35
+#define SYS_sched_deadline 36
+#define SYS_setclass 37
+#define SYS_freemem 38
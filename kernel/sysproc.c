@@ -5,6 +5,7 @@
 #include "memlayout.h"
 #include "spinlock.h"
 #include "proc.h"
+#include "idlestat.h"
 
 uint64
 sys_exit(void)
@@ -35,6 +36,20 @@ sys_wait(void)
   return wait(p);
 }
 
+// waitpid(pid, status, options, rusage); see waitpid() in proc.c.
+uint64
+sys_waitpid(void)
+{
+  int pid, options;
+  uint64 status, ru;
+
+  argint(0, &pid);
+  argaddr(1, &status);
+  argint(2, &options);
+  argaddr(3, &ru);
+  return waitpid(pid, status, options, ru);
+}
+
 uint64
 sys_sbrk(void)
 {
@@ -96,6 +111,9 @@ sys_uptime(void)
 extern int chpr(int, int);
 extern int chtickets(int, int);
 extern int wait2(uint64, uint64, uint64);
+extern int mkcurrency(int);
+extern int chcurrency(int, int);
+extern int setclass(int, int, int);
 
 uint64
 sys_chpr(void)
@@ -107,9 +125,32 @@ sys_chpr(void)
   return chpr(pid, pr);
 }
 
+// Give up the CPU. For a deadline process this ends the
+// current job, so it sleeps until the next one is released.
 uint64
 sys_yield(void) {
-  yield();
+  struct proc *p = myproc();
+  uint next;
+
+  acquire(&p->lock);
+  next = dldone(p);
+  release(&p->lock);
+  if(next == 0){
+    // yield() is shared with preemption, so count the
+    // voluntary switch here; sleep() counts its own.
+    p->nvcsw++;
+    yield();
+    return 0;
+  }
+  acquire(&tickslock);
+  while(ticks < next){
+    if(killed(p)){
+      release(&tickslock);
+      return -1;
+    }
+    sleep(&ticks, &tickslock);
+  }
+  release(&tickslock);
   return 0;
 }
 
@@ -123,47 +164,77 @@ sys_chtickets(void)
   return chtickets(pid, tickets);
 }
 
+uint64
+sys_mkcurrency(void)
+{
+  int funding;
+  argint(0, &funding);
+
+  return mkcurrency(funding);
+}
+
+uint64
+sys_chcurrency(void)
+{
+  int pid, id;
+  argint(0, &pid);
+  argint(1, &id);
+
+  return chcurrency(pid, id);
+}
+
+// Switch scheduling policy; see kernel/policy.h.
+uint64
+sys_setsched(void)
+{
+  int policy;
+  argint(0, &policy);
+
+  return setsched(policy);
+}
+
 uint64
 sys_getppid(void)
 {
   return myproc()->parent->pid;
 }
 
-// copy elements from the kernel ptable to the user space
-extern struct proc * getptable_proc(void);
-
-uint64
-sys_getptable(void){
-  int size;
-  uint64 buf_addr;
-  char *buf;
-  char *s;
-  struct proc *p = '\0';
-
-  argint(0, &size);
-  argaddr(1, &buf_addr);
-  buf = (char*)buf_addr;
-
-  s = buf;
-  p = getptable_proc();
-
-  while(buf + size > s && p->state != UNUSED){
-    *(int *)s = p->state;
-    s+=4;
-    *(int *)s = p->pid;
-    s+=4;
-    *(int *)s = p->parent->pid;
-    s+=4;
-    *(int *)s = p->priority;
-    s+=4;
-    *(int *)s = p->tickets;
-    s+=4;
-    *(int *)s = p->ctime;
-    s+=4;
-    memmove(s,p->name,16);
-    s+=16;
-    p++;
+// Copy up to n records about the live processes to the
+// struct procstat array at addr; see kernel/procstat.h.
+// Returns the number of records copied.
+uint64
+sys_procstat(void)
+{
+  uint64 addr;
+  int n;
+
+  argaddr(0, &addr);
+  argint(1, &n);
+  return procstat(addr, n);
+}
+
+uint64
+sys_idlestat(void)
+{
+  uint64 addr;
+  struct idlestat st;
+  struct cpu *c;
+  uint64 start;
+  int i;
+
+  argaddr(0, &addr);
+  st.now = r_time();
+  for(i = 0; i < NCPU; i++){
+    c = &cpus[i];
+    st.online[i] = c->online;
+    st.idle[i] = c->idletime;
+    // count the wait a CPU is in the middle of, too.
+    start = c->idlestart;
+    if(start && start < st.now)
+      st.idle[i] += st.now - start;
   }
+  if(copyout(myproc()->pagetable, addr, (char*)&st, sizeof(st)) < 0)
+    return -1;
   return 0;
 }
 
@@ -177,3 +248,76 @@ sys_wait2(void) {
   
   return wait2(retime_addr, rutime_addr, stime_addr);
 }
+
+// Copy the scheduler latency histograms to a struct schedlat;
+// see kernel/schedlat.h.
+uint64
+sys_schedlat(void)
+{
+  uint64 addr;
+
+  argaddr(0, &addr);
+  return schedlat(addr);
+}
+
+// Turn scheduler tracing on or off; see kernel/trace.c.
+uint64
+sys_settrace(void)
+{
+  int on;
+
+  argint(0, &on);
+  return settrace(on);
+}
+
+// Copy the NCPU trace rings to an array of struct tracering.
+uint64
+sys_traceread(void)
+{
+  uint64 addr;
+
+  argaddr(0, &addr);
+  return traceread(addr);
+}
+
+// Make the calling process a deadline process that needs
+// runtime ticks of every period ticks, within deadline ticks
+// of the start of each period; see kernel/sched_deadline.c.
+// All three 0 make it a normal process again. Returns -1 if
+// the deadline processes would need more than one CPU.
+uint64
+sys_sched_deadline(void)
+{
+  struct proc *p = myproc();
+  int runtime, period, deadline, r;
+
+  argint(0, &runtime);
+  argint(1, &period);
+  argint(2, &deadline);
+  acquire(&p->lock);
+  r = dlset(p, runtime, period, deadline);
+  release(&p->lock);
+  return r;
+}
+
+// Move process pid to a scheduling class (CLASS_RT, CLASS_NORMAL
+// or CLASS_IDLE in kernel/policy.h), with priority prio from 1,
+// the highest, to NRTPRIO if it is CLASS_RT. Returns -1 if
+// there is no such class or process.
+uint64
+sys_setclass(void)
+{
+  int pid, class, prio;
+
+  argint(0, &pid);
+  argint(1, &class);
+  argint(2, &prio);
+  return setclass(pid, class, prio);
+}
+
+// The number of free pages of physical memory.
+uint64
+sys_freemem(void)
+{
+  return kfreepages();
+}
@@ -0,0 +1,63 @@
+// Scheduler event tracing.
+//
+// Each CPU appends to its own ring with interrupts off, so the
+// rings need no locks: an event is written before head moves
+// past it. traceread() copies the rings out as they are, so an
+// event being overwritten while it is copied may come out
+// torn; the tracer reading them expects that.
+
+#include "types.h"
+#include "param.h"
+#include "memlayout.h"
+#include "riscv.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "trace.h"
+#include "defs.h"
+
+int tracing;
+static struct tracering rings[NCPU];
+
+// Log an event in this CPU's ring. Use TRACE() rather than
+// calling this directly.
+void
+trace(int type, int pid, int from, int to)
+{
+  struct tracering *r;
+  struct traceevent *e;
+  int id;
+
+  push_off();
+  id = cpuid();
+  r = &rings[id];
+  e = &r->ev[r->head % NTRACE];
+  e->time = r_time();
+  e->pid = pid;
+  e->type = type;
+  e->cpu = id;
+  e->from = from;
+  e->to = to;
+  __sync_synchronize();
+  r->head++;
+  pop_off();
+}
+
+// Turn tracing on (1) or off (0); -1 leaves it as it is.
+// Returns whether it was on.
+int
+settrace(int on)
+{
+  int old = tracing;
+
+  if(on >= 0)
+    tracing = on != 0;
+  return old;
+}
+
+// Copy the rings of all NCPU CPUs to the array of struct
+// tracering at addr.
+int
+traceread(uint64 addr)
+{
+  return copyout(myproc()->pagetable, addr, (char*)rings, sizeof(rings));
+}
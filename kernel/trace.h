@@ -0,0 +1,30 @@
+// Scheduler event tracing. Each CPU logs events into its own
+// ring of the last NTRACE; see trace.c.
+#define NTRACE 512
+
+#define TRACE_SWITCHIN   1     // p starts running
+#define TRACE_SWITCHOUT  2     // p stops running
+#define TRACE_WAKEUP     3     // p woken up by wakeup()
+#define TRACE_FORK       4     // p created by fork()
+#define TRACE_EXIT       5     // p exited
+#define TRACE_MIGRATE    6     // p stolen from CPU from to CPU to
+
+struct traceevent {
+  uint64 time;                 // r_time()
+  int pid;
+  uchar type;                  // TRACE_*
+  uchar cpu;                   // CPU that logged the event
+  uchar from;                  // p's state before, or CPU for TRACE_MIGRATE
+  uchar to;                    // p's state after, or CPU for TRACE_MIGRATE
+};
+
+struct tracering {
+  uint64 head;                 // Events logged so far; the next goes in ev[head % NTRACE]
+  struct traceevent ev[NTRACE];
+};
+
+// A tracepoint, for the kernel. When tracing is off it costs
+// a load and a branch that always goes the same way.
+extern int tracing;
+#define TRACE(type, pid, from, to) \
+  do { if(tracing) trace((type), (pid), (from), (to)); } while(0)
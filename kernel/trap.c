@@ -11,9 +11,6 @@ uint ticks;
 
 extern char trampoline[], uservec[], userret[];
 
-// Scheduling statistics update function
-void updatestatistics(void);
-
 // in kernelvec.S, calls kerneltrap().
 void kernelvec();
 
@@ -73,6 +70,7 @@ usertrap(void)
   } else if(r_scause() == 13 || r_scause() == 15) {
     // Page fault (13 = load page fault, 15 = store/AMO page fault)
     uint64 va = r_stval();
+    p->pgfaults++;
     if(va >= p->sz || va < PGSIZE) {
       // Invalid address
       printf("usertrap(): page fault on invalid address 0x%lx pid=%d\n", va, p->pid);
@@ -140,9 +138,12 @@ usertrap(void)
   if(killed(p))
     exit(-1);
 
-  // give up the CPU if this is a timer interrupt.
-  if(which_dev == 2)
+  // give up the CPU if this is a timer interrupt and the
+  // scheduling policy wants it back, or if a wakeup asked.
+  if((which_dev == 2 && schedtick(p)) || needresched()){
+    p->nivcsw++;
     yield();
+  }
 
   usertrapret();
 }
@@ -214,9 +215,12 @@ kerneltrap()
     panic("kerneltrap");
   }
 
-  // give up the CPU if this is a timer interrupt.
-  if(which_dev == 2 && myproc() != 0)
+  // give up the CPU if this is a timer interrupt and the
+  // scheduling policy wants it back, or if a wakeup asked.
+  if(myproc() != 0 && ((which_dev == 2 && schedtick(myproc())) || needresched())){
+    myproc()->nivcsw++;
     yield();
+  }
 
   // the yield() may have caused some traps to occur,
   // so restore trap registers for use by kernelvec.S's sepc instruction.
@@ -234,13 +238,17 @@ clockintr()
     release(&tickslock);
   }
 
-  // Update scheduling statistics
-  updatestatistics();
-
   // ask for the next timer interrupt. this also clears
-  // the interrupt request. 1000000 is about a tenth
+  // the interrupt request. QUANTUM is about a tenth
   // of a second.
-  w_stimecmp(r_time() + 1000000);
+  w_stimecmp(r_time() + QUANTUM);
+}
+
+// interrupt hart, e.g. to wake it from wfi.
+void
+ipi(int hart)
+{
+  *(volatile uint32*)CLINT_MSIP(hart) = 1;
 }
 
 // check if it's an external interrupt or software interrupt,
@@ -278,6 +286,12 @@ devintr()
     // timer interrupt.
     clockintr();
     return 2;
+  } else if(scause == 0x8000000000000001L){
+    // software interrupt from another hart, via machinevec
+    // in kernelvec.S, to wake this hart up or to make its
+    // process yield (see resched() in sched.c).
+    w_sip(r_sip() & ~SIP_SSIP);
+    return 1;
   } else {
     return 0;
   }
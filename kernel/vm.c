@@ -16,7 +16,7 @@ void kvminit(void)
  * @note  
  * 1.内核页表采用直接映射的方式映射 KERNBASE-PHYSTOP 的物理内存到内核虚拟地址空间
  * 2.trampoline页被映射到虚拟地址空间的顶端
- * 3.将每个进程的内核栈映射到内核虚拟地址空间的高地址
+ * 3.进程的内核栈在创建进程槽位时才映射，见 proc.c 的 newslot()
  */
 pagetable_t kvmmake(void)
 {
@@ -33,6 +33,9 @@ pagetable_t kvmmake(void)
     // 将 VIRTIO0 的物理地址直接映射到内核虚拟地址空间，设置为可读可写，用于虚拟块设备访问
     kvmmap(kpgtbl, VIRTIO0, VIRTIO0, PGSIZE, PTE_R | PTE_W);
 
+    // 映射 CLINT 的 MSIP 寄存器，用于向其他 hart 发送处理器间中断(IPI)
+    kvmmap(kpgtbl, CLINT, CLINT, PGSIZE, PTE_R | PTE_W);
+
     // 将 PLIC 的物理地址直接映射到内核虚拟地址空间，设置为可读可写
     kvmmap(kpgtbl, PLIC, PLIC, 0x4000000, PTE_R | PTE_W);
 
@@ -45,9 +48,6 @@ pagetable_t kvmmake(void)
     // 将 trampoline 页映射到内核虚拟地址空间的高端（TRAMPOLINE 处），用于用户态与内核态之间切换的入口，权限为只读和可执行
     kvmmap(kpgtbl, TRAMPOLINE, (uint64)trampoline, PGSIZE, PTE_R | PTE_X);
 
-    // 为所有进程预留并映射内核栈空间（每个进程一个栈），用于处理内核态上下文（如系统调用或中断）
-    proc_mapstacks(kpgtbl);
-
     return kpgtbl;
 }
 
@@ -204,6 +204,8 @@ int mappages(pagetable_t pagetable, uint64 va, uint64 size, uint64 pa, int perm)
             panic("mappages: remap");
         // 将物理地址 pa 转换为 PTE 格式，并设置权限和有效标志
         *pte = PA2PTE(pa) | perm | PTE_V;
+        if (perm & PTE_U)
+            rssadd(pagetable, 1);
 
         // 最后一页则退出循环
         if (a == last)
@@ -257,6 +259,8 @@ void uvmunmap(pagetable_t pagetable, uint64 va, uint64 npages, int do_free)
             }
         }
         
+        if (*pte & PTE_U)
+            rssadd(pagetable, -1);
         // 将页表项清零，取消映射
         *pte = 0;
     }
@@ -385,6 +389,29 @@ void freewalk(pagetable_t pagetable)
     kfree((void *)pagetable);
 }
 
+/**
+ * @brief 递归地统计页表中映射的用户物理页数，即常驻集大小
+ * @param pagetable 要统计的页表
+ * @return 有效且带 PTE_U 的叶级页表项数目
+ */
+uint64 uvmrss(pagetable_t pagetable)
+{
+    uint64 n = 0;
+
+    for (int i = 0; i < 512; i++) {
+        pte_t pte = pagetable[i];
+
+        if ((pte & PTE_V) == 0)
+            continue;
+        // 非叶级页表项，递归统计下级页表
+        if ((pte & (PTE_R | PTE_W | PTE_X)) == 0)
+            n += uvmrss((pagetable_t)PTE2PA(pte));
+        else if (pte & PTE_U)
+            n++;
+    }
+    return n;
+}
+
 /**
  * @brief 取消用户页表映射关系，然后释放用户页表的物理内存，
  */
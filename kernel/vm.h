@@ -43,6 +43,7 @@ void uvmfree(pagetable_t pagetable, uint64 sz);
 int uvmcopy(pagetable_t old_pagetable, pagetable_t new_pagetable, uint64 sz);
 void uvmclear(pagetable_t pagetable, uint64 va);
 void freewalk(pagetable_t pagetable);
+uint64 uvmrss(pagetable_t pagetable);
 
 /* 内核空间和用户空间之间的数据拷贝 (Cross-space Data Transfer) */
 int copyout(pagetable_t pagetable, uint64 dstva, char *src, uint64 len);
@@ -0,0 +1,569 @@
+// Scheduling policy simulator, run on the host.
+//
+//   sim [-p policy|all] [-c ncpu] [-w cpu|io|mixed] [-n njobs]
+//       [-s seed] [-r runs] [trace]
+//
+// Runs the kernel's scheduling policies on a discrete-event
+// model of the rest of the kernel, so comparing them takes
+// milliseconds instead of a QEMU boot per data point. The
+// policies (kernel/sched_*.c), the run queue operations they
+// share (kernel/runq.c) and kernel/rbtree.c are compiled as
+// they are; this file stands in for proc.c and sched.c:
+//  - a job is a process that alternates CPU bursts and I/O
+//    waits; it is queued on CPU (slot % ncpu) when it arrives
+//    and on the CPU it last ran on when its I/O completes;
+//  - every CPU takes a timer interrupt each QUANTUM cycles and
+//    asks its running process's policy whether to preempt it,
+//    and CPU 0's interrupts advance ticks;
+//  - a CPU that is idle takes the next process off its own run
+//    queue or steals one from the busiest other CPU, as
+//    runqget() does. Switching and waking cost nothing.
+//
+// The jobs come from the trace file, or are generated from
+// seed: cpu jobs run one long burst, io jobs run many short
+// bursts separated by I/O, and mixed alternates the two. A
+// trace has one job per line, times in milliseconds (a tick is
+// 100 ms):
+//
+//   arrival priority tickets cpu [io cpu]...
+//
+// where priority 0 means the policy's default. '#' starts a
+// comment. For each run and policy sim prints one line with
+// the makespan, the number of context switches, the mean, 90th percentile and worst
+// turnaround and response time (arrival to first run), in
+// milliseconds, and Jain's fairness index, in thousandths, of
+// the fraction of its turnaround each job spent running. With
+// -r, runs use seeds seed, seed+1, and so on.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "kernel/types.h"
+#include "kernel/param.h"
+#include "kernel/riscv.h"
+#include "kernel/spinlock.h"
+#include "kernel/proc.h"
+#include "kernel/rbtree.h"
+#include "kernel/policy.h"
+#include "kernel/schedtab.h"
+#include "kernel/sched.h"
+
+#define MAXBURST 256           // CPU bursts and I/O waits per job
+#define MS (QUANTUM / 100)     // Cycles per millisecond
+#define NEVER ((uint64)-1)
+
+// What proc.c and sched.c provide to the policies.
+struct cpu cpus[NCPU];
+struct proc *procs[NPROC];
+uint ticks;
+
+static struct schedpolicy *policies[] = {
+[SCHED_DEFAULT]  &rrpolicy,
+[SCHED_PRIORITY] &priopolicy,
+[SCHED_FCFS]     &fcfspolicy,
+[SCHED_LOTTERY]  &lotterypolicy,
+[SCHED_SML]      &smlpolicy,
+[SCHED_STRIDE]   &stridepolicy,
+[SCHED_FAIR]     &fairpolicy,
+[SCHED_MLFQ]     &mlfqpolicy,
+[SCHED_SRTF]     &srtfpolicy,
+};
+
+static char *names[] = SCHEDNAMES;
+
+#define NPOLICY (sizeof(policies) / sizeof(policies[0]))
+
+struct job {
+  int arrival;                 // Milliseconds
+  int priority;                // 0 for the policy's default
+  int tickets;
+  int nburst;                  // CPU bursts and I/O waits, CPU first
+  int burst[MAXBURST];         // Milliseconds
+};
+
+// A job while it is being simulated.
+struct sjob {
+  struct job *job;
+  int next;                    // Index of the burst or wait under way
+  uint64 left;                 // Cycles left of the current CPU burst
+  uint64 wakeat;               // When the current I/O wait ends
+  uint64 first;                // When the job first ran, or NEVER
+  uint64 finish;               // When the job exited
+  uint64 ran;                  // Cycles spent running
+};
+
+struct scpu {
+  struct proc *p;              // Running process, or 0
+  uint64 start;                // When p was switched in
+  uint64 nexttick;             // Next timer interrupt
+};
+
+static struct job jobs[NPROC];
+static int njob;
+
+static struct proc ptab[NPROC];
+static struct sjob sjobs[NPROC];
+static struct runq runqs[NCPU];
+static struct scpu scpus[NCPU];
+static int ncpu = 1;
+static int curcpu;             // CPU mycpu() returns
+static uint64 now;             // Cycles since the simulation started
+static int nswitch;            // Processes switched to
+
+void
+panic(char *s)
+{
+  fprintf(stderr, "sim: panic: %s\n", s);
+  exit(1);
+}
+
+void
+initlock(struct spinlock *lk, char *name)
+{
+  lk->name = name;
+  lk->locked = 0;
+  lk->cpu = 0;
+}
+
+// Nothing runs concurrently, so locks need do nothing.
+void
+acquire(struct spinlock *lk)
+{
+}
+
+void
+release(struct spinlock *lk)
+{
+}
+
+struct cpu*
+mycpu(void)
+{
+  return &cpus[curcpu];
+}
+
+// Only reached through setcurrency() and ticketlend(), which
+// no job calls.
+void
+runqrequeue(struct proc *p)
+{
+  panic("runqrequeue");
+}
+
+static uint rstate;
+
+// xorshift32; rstate must not be zero.
+static uint
+rnd(void)
+{
+  rstate ^= rstate << 13;
+  rstate ^= rstate >> 17;
+  rstate ^= rstate << 5;
+  return rstate;
+}
+
+// A number between lo and hi inclusive.
+static int
+between(int lo, int hi)
+{
+  return lo + rnd() % (hi - lo + 1);
+}
+
+static void
+usage(void)
+{
+  fprintf(stderr, "usage: sim [-p policy|all] [-c ncpu] [-w cpu|io|mixed] "
+          "[-n njobs] [-s seed] [-r runs] [trace]\n");
+  exit(1);
+}
+
+// Generate n jobs of workload w ("cpu", "io" or "mixed").
+static void
+generate(char *w, int n, uint seed)
+{
+  struct job *j;
+  int i, k, io, rounds;
+
+  rstate = seed * 2654435761U + 1;
+  for(i = 0; i < n; i++){
+    j = &jobs[i];
+    if(strcmp(w, "cpu") == 0)
+      io = 0;
+    else if(strcmp(w, "io") == 0)
+      io = 1;
+    else
+      io = i % 2;
+    j->arrival = between(0, 999);
+    j->priority = 0;
+    j->tickets = 1;
+    if(io){
+      rounds = between(10, 50);
+      j->nburst = 0;
+      for(k = 0; k < rounds; k++){
+        j->burst[j->nburst++] = between(1, 10);
+        j->burst[j->nburst++] = between(5, 50);
+      }
+      j->burst[j->nburst++] = between(1, 10);
+    } else {
+      j->nburst = 1;
+      j->burst[0] = between(200, 2000);
+    }
+  }
+  njob = n;
+}
+
+// Read jobs from the trace file path.
+static void
+readtrace(char *path)
+{
+  FILE *f;
+  char line[4096], *s, *e;
+  int v[3 + MAXBURST];
+  int i, n, lineno;
+  struct job *j;
+
+  if((f = fopen(path, "r")) == 0){
+    perror(path);
+    exit(1);
+  }
+  njob = 0;
+  lineno = 0;
+  while(fgets(line, sizeof(line), f)){
+    lineno++;
+    if((s = strchr(line, '#')) != 0)
+      *s = 0;
+    n = 0;
+    for(s = line; n < 3 + MAXBURST; s = e){
+      v[n] = strtol(s, &e, 10);
+      if(e == s)
+        break;
+      n++;
+    }
+    if(n == 0)
+      continue;
+    for(i = 3; i < n; i++)
+      if(v[i] < 0)
+        break;
+    if(n < 4 || n % 2 == 1 || v[0] < 0 || v[1] < 0 || i < n || njob == NPROC){
+      fprintf(stderr, "sim: %s:%d: bad job\n", path, lineno);
+      exit(1);
+    }
+    j = &jobs[njob++];
+    j->arrival = v[0];
+    j->priority = v[1];
+    j->tickets = v[2];
+    j->nburst = n - 3;
+    memmove(j->burst, v + 3, j->nburst * sizeof(v[0]));
+  }
+  fclose(f);
+}
+
+// Switch CPU c to p, as scheduler() does.
+static void
+run(int c, struct proc *p)
+{
+  struct sjob *sj = &sjobs[p->slot];
+
+  p->cpu = c;
+  p->state = RUNNING;
+  p->used = 0;                 // as runqstart() does
+  nswitch++;
+  scpus[c].p = p;
+  scpus[c].start = now;
+  if(sj->first == NEVER)
+    sj->first = now;
+}
+
+// Take the running process off CPU c, leaving it in state,
+// as sched() and runqdone() do.
+static void
+stop(int c, enum procstate state)
+{
+  struct proc *p = scpus[c].p;
+  struct sjob *sj = &sjobs[p->slot];
+  uint64 ran = now - scpus[c].start;
+
+  curcpu = c;
+  sj->left -= ran;
+  sj->ran += ran;
+  p->state = state;
+  if(p->policy->charge)
+    p->policy->charge(p, ran);
+  if(state == RUNNABLE)
+    rqenqueue(&runqs[c], p, 0);
+  else
+    deactivate(p);
+  scpus[c].p = 0;
+}
+
+// Make p RUNNABLE and queue it on the CPU it last ran on,
+// preempting the process running there if p should go first,
+// as setrunnable() does.
+static void
+wake(struct proc *p)
+{
+  struct proc *cur = scpus[p->cpu].p;
+
+  p->state = RUNNABLE;
+  activate(p);
+  curcpu = p->cpu;
+  rqenqueue(&runqs[p->cpu], p, 1);
+  if(cur && p->policy->preempt && p->policy->preempt(p, cur))
+    stop(p->cpu, RUNNABLE);
+}
+
+// The next process for idle CPU c, as runqget() finds it.
+static struct proc*
+next(int c)
+{
+  struct runq *victim;
+  struct proc *p;
+  int i, most;
+
+  curcpu = c;
+  if((p = rqpick(&runqs[c])) != 0)
+    return p;
+  victim = 0;
+  most = 0;
+  for(i = 1; i < ncpu; i++){
+    if(runqs[(c + i) % ncpu].n > most){
+      victim = &runqs[(c + i) % ncpu];
+      most = victim->n;
+    }
+  }
+  if(victim == 0)
+    return 0;
+  p = rqpick(victim);
+  if(victim->policy->steal)
+    victim->policy->steal(victim, &runqs[c], p);
+  return p;
+}
+
+// The job in slot i, running on CPU c, has finished burst
+// sj->next; start its next I/O wait, or exit. Returns 1 if it
+// exited.
+static int
+advance(int c, int i)
+{
+  struct sjob *sj = &sjobs[i];
+
+  sj->next++;
+  if(sj->next >= sj->job->nburst){
+    stop(c, ZOMBIE);
+    sj->finish = now;
+    return 1;
+  }
+  stop(c, SLEEPING);
+  sj->wakeat = now + (uint64)sj->job->burst[sj->next] * MS;
+  return 0;
+}
+
+// Job i arrives.
+static void
+arrive(int i, struct schedpolicy *pol)
+{
+  struct proc *p = &ptab[i];
+  struct sjob *sj = &sjobs[i];
+
+  memset(p, 0, sizeof(*p));
+  p->slot = i;
+  p->pid = i + 1;
+  p->priority = sj->job->priority ? sj->job->priority : pol->prio;
+  p->tickets = sj->job->tickets;
+  p->ctime = ticks;
+  p->class = CLASS_NORMAL;
+  p->cpu = i % ncpu;
+  sj->left = (uint64)sj->job->burst[0] * MS;
+  wake(p);
+}
+
+static int
+cmparrival(const void *a, const void *b)
+{
+  return ((struct job*)a)->arrival - ((struct job*)b)->arrival;
+}
+
+static int
+cmpu64(const void *a, const void *b)
+{
+  uint64 x = *(uint64*)a, y = *(uint64*)b;
+
+  return x < y ? -1 : x > y;
+}
+
+// Print the mean, 90th percentile and worst of v[0..n-1],
+// converted to milliseconds, as key_mean=, key_p90=, key_max=.
+static void
+report(char *key, uint64 *v, int n)
+{
+  uint64 sum = 0;
+  int i;
+
+  qsort(v, n, sizeof(v[0]), cmpu64);
+  for(i = 0; i < n; i++)
+    sum += v[i];
+  printf(" %s_mean=%lu %s_p90=%lu %s_max=%lu", key, sum / n / MS,
+         key, v[n * 9 / 10] / MS, key, v[n - 1] / MS);
+}
+
+// Run every job under policy id and print the results.
+static void
+simulate(int id, char *wname, uint seed)
+{
+  struct schedpolicy *pol = policies[id];
+  static uint64 turn[NPROC], resp[NPROC];
+  struct sjob *sj;
+  struct proc *p;
+  uint64 t, x, xsum, xsq;
+  int i, c, arrived, done;
+
+  memset(runqs, 0, sizeof(runqs));
+  memset(cpus, 0, sizeof(cpus));
+  memset(scpus, 0, sizeof(scpus));
+  for(i = 0; i < NPROC; i++)
+    procs[i] = &ptab[i];
+  for(c = 0; c < ncpu; c++){
+    runqs[c].policy = pol;
+    scpus[c].nexttick = QUANTUM;
+  }
+  lotteryinit();
+  dlinit();
+  for(i = 0; i < njob; i++){
+    memset(&sjobs[i], 0, sizeof(sjobs[i]));
+    sjobs[i].job = &jobs[i];
+    sjobs[i].first = NEVER;
+    sjobs[i].wakeat = NEVER;
+  }
+  now = 0;
+  ticks = 0;
+  nswitch = 0;
+  arrived = done = 0;
+
+  while(done < njob){
+    // the next event.
+    t = arrived < njob ? (uint64)jobs[arrived].arrival * MS : NEVER;
+    for(i = 0; i < arrived; i++)
+      if(sjobs[i].wakeat < t)
+        t = sjobs[i].wakeat;
+    for(c = 0; c < ncpu; c++){
+      if(scpus[c].nexttick < t)
+        t = scpus[c].nexttick;
+      if(scpus[c].p && scpus[c].start + sjobs[scpus[c].p->slot].left < t)
+        t = scpus[c].start + sjobs[scpus[c].p->slot].left;
+    }
+    now = t;
+
+    // bursts that end now, then I/O that completes and jobs
+    // that arrive, then timer interrupts.
+    for(c = 0; c < ncpu; c++){
+      if(scpus[c].p == 0)
+        continue;
+      i = scpus[c].p->slot;
+      if(scpus[c].start + sjobs[i].left == now)
+        done += advance(c, i);
+    }
+    for(i = 0; i < arrived; i++){
+      sj = &sjobs[i];
+      if(sj->wakeat == now){
+        sj->wakeat = NEVER;
+        sj->next++;
+        sj->left = (uint64)sj->job->burst[sj->next] * MS;
+        wake(&ptab[i]);
+      }
+    }
+    while(arrived < njob && (uint64)jobs[arrived].arrival * MS == now)
+      arrive(arrived++, pol);
+    for(c = 0; c < ncpu; c++){
+      if(scpus[c].nexttick != now)
+        continue;
+      scpus[c].nexttick += QUANTUM;
+      if(c == 0)
+        ticks++;
+      curcpu = c;
+      if(scpus[c].p && scpus[c].p->policy->tick(&runqs[c], scpus[c].p))
+        stop(c, RUNNABLE);
+    }
+
+    for(c = 0; c < ncpu; c++){
+      if(scpus[c].p == 0 && (p = next(c)) != 0)
+        run(c, p);
+    }
+  }
+
+  xsum = xsq = 0;
+  for(i = 0; i < njob; i++){
+    sj = &sjobs[i];
+    turn[i] = sj->finish - (uint64)sj->job->arrival * MS;
+    resp[i] = sj->first - (uint64)sj->job->arrival * MS;
+    x = turn[i] ? sj->ran * 1000 / turn[i] : 1000;
+    xsum += x;
+    xsq += x * x;
+  }
+  if(xsq == 0)
+    xsq = 1;
+  printf("sim policy=%s workload=%s seed=%u jobs=%d cpus=%d makespan=%lu switches=%d",
+         names[id], wname, seed, njob, ncpu, now / MS, nswitch);
+  report("turn", turn, njob);
+  report("resp", resp, njob);
+  printf(" jain=%d/1000\n", (int)(xsum * xsum * 1000 / (njob * xsq)));
+}
+
+int
+main(int argc, char *argv[])
+{
+  char *pname = "all", *wname = "mixed", *trace = 0;
+  int n = 20, runs = 1;
+  uint seed = 1;
+  int opt, id, r;
+
+  while((opt = getopt(argc, argv, "p:c:w:n:s:r:")) != -1){
+    switch(opt){
+    case 'p': pname = optarg; break;
+    case 'c': ncpu = atoi(optarg); break;
+    case 'w': wname = optarg; break;
+    case 'n': n = atoi(optarg); break;
+    case 's': seed = atoi(optarg); break;
+    case 'r': runs = atoi(optarg); break;
+    default: usage();
+    }
+  }
+  if(optind < argc - 1)
+    usage();
+  if(optind == argc - 1){
+    trace = argv[optind];
+    wname = trace;
+    runs = 1;
+  }
+  if(ncpu < 1 || ncpu > NCPU || n < 1 || n > NPROC || runs < 1)
+    usage();
+  if(strcmp(wname, "cpu") != 0 && strcmp(wname, "io") != 0 &&
+     strcmp(wname, "mixed") != 0 && trace == 0)
+    usage();
+  for(id = 0; id < NPOLICY; id++)
+    if(strcmp(pname, names[id]) == 0)
+      break;
+  if(id == NPOLICY && strcmp(pname, "all") != 0)
+    usage();
+
+  for(r = 0; r < runs; r++){
+    if(trace)
+      readtrace(trace);
+    else
+      generate(wname, n, seed + r);
+    if(njob == 0){
+      fprintf(stderr, "sim: no jobs\n");
+      exit(1);
+    }
+    // arrive() relies on slots being in order of arrival.
+    qsort(jobs, njob, sizeof(jobs[0]), cmparrival);
+    if(id < NPOLICY){
+      simulate(id, wname, seed + r);
+    } else {
+      for(id = 0; id < NPOLICY; id++)
+        simulate(id, wname, seed + r);
+    }
+  }
+  exit(0);
+}
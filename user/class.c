@@ -0,0 +1,52 @@
+// Run a command in a scheduling class.
+//
+//   class rt prio command [args...]
+//   class normal command [args...]
+//   class idle command [args...]
+//
+// rt runs it ahead of every normal process at real-time
+// priority prio, 1 (the highest) to NRTPRIO; idle runs it only
+// when nothing else wants the CPU, e.g. a background rebuild
+// that should not slow down interactive work. Children of the
+// command inherit the class.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/policy.h"
+#include "user/user.h"
+
+static void
+usage(void)
+{
+  fprintf(2, "usage: class rt prio|normal|idle command [args...]\n");
+  exit(1);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int class, prio = 0, i = 2;
+
+  if(argc < 3)
+    usage();
+  if(strcmp(argv[1], "rt") == 0){
+    class = CLASS_RT;
+    prio = atoi(argv[2]);
+    i = 3;
+  } else if(strcmp(argv[1], "normal") == 0)
+    class = CLASS_NORMAL;
+  else if(strcmp(argv[1], "idle") == 0)
+    class = CLASS_IDLE;
+  else
+    usage();
+  if(i >= argc)
+    usage();
+
+  if(setclass(getpid(), class, prio) < 0){
+    fprintf(2, "class: setclass %s failed\n", argv[1]);
+    exit(1);
+  }
+  exec(argv[i], argv + i);
+  fprintf(2, "class: exec %s failed\n", argv[i]);
+  exit(1);
+}
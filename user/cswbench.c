@@ -0,0 +1,109 @@
+// Context-switch throughput benchmark.
+//
+//   cswbench [nproc [rounds]]
+//
+// Forks nproc children that each call yield() rounds times,
+// then forks nproc/2 pairs that bounce one byte back and forth
+// over a pair of pipes rounds times, so that every round trip
+// is a sleep() and a wakeup() on each side.
+// Prints one line per workload with the number of switches
+// per clock tick. Boot with make qemu CPUS=1 ... CPUS=8 and
+// run it on each to compare scaling across harts.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "user/user.h"
+
+static void
+report(char *name, int nproc, int rounds, int switches, int ticks)
+{
+  if(ticks == 0)
+    ticks = 1;
+  printf("cswbench %s nproc=%d rounds=%d switches=%d ticks=%d switches/tick=%d\n",
+         name, nproc, rounds, switches, ticks, switches / ticks);
+}
+
+static void
+yieldbench(int nproc, int rounds)
+{
+  int i, j, t0;
+
+  t0 = uptime();
+  for(i = 0; i < nproc; i++){
+    int pid = fork();
+    if(pid < 0){
+      fprintf(2, "cswbench: fork failed\n");
+      exit(1);
+    }
+    if(pid == 0){
+      for(j = 0; j < rounds; j++)
+        yield();
+      exit(0);
+    }
+  }
+  for(i = 0; i < nproc; i++)
+    wait(0);
+  report("yield", nproc, rounds, nproc * rounds, uptime() - t0);
+}
+
+static void
+pipebench(int nproc, int rounds)
+{
+  int npair = nproc / 2;
+  int i, j, t0;
+  int ab[2], ba[2];
+  char c = 0;
+
+  if(npair == 0)
+    npair = 1;
+
+  t0 = uptime();
+  for(i = 0; i < npair; i++){
+    if(pipe(ab) < 0 || pipe(ba) < 0){
+      fprintf(2, "cswbench: pipe failed\n");
+      exit(1);
+    }
+    if(fork() == 0){
+      for(j = 0; j < rounds; j++){
+        write(ab[1], &c, 1);
+        read(ba[0], &c, 1);
+      }
+      exit(0);
+    }
+    if(fork() == 0){
+      for(j = 0; j < rounds; j++){
+        read(ab[0], &c, 1);
+        write(ba[1], &c, 1);
+      }
+      exit(0);
+    }
+    close(ab[0]);
+    close(ab[1]);
+    close(ba[0]);
+    close(ba[1]);
+  }
+  for(i = 0; i < 2 * npair; i++)
+    wait(0);
+  // each round trip blocks and wakes both sides once.
+  report("pipe", 2 * npair, rounds, 2 * npair * rounds, uptime() - t0);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int nproc = 4;
+  int rounds = 10000;
+
+  if(argc > 1)
+    nproc = atoi(argv[1]);
+  if(argc > 2)
+    rounds = atoi(argv[2]);
+  if(nproc < 1 || rounds < 1){
+    fprintf(2, "usage: cswbench [nproc [rounds]]\n");
+    exit(1);
+  }
+
+  yieldbench(nproc, rounds);
+  pipebench(nproc, rounds);
+  exit(0);
+}
@@ -0,0 +1,153 @@
+// Test deadline scheduling.
+//
+//   dltest
+//
+// Starts NNOISE CPU-bound processes, then two deadline
+// processes that each need RUNTIME of every PERIOD ticks and
+// use about half a tick of it per job, and a third whose jobs
+// need more than a period. Checks that sched_deadline() rejects
+// bad parameters and a set that would need more than a CPU,
+// that the two well-behaved processes miss no deadlines over
+// NJOB jobs, and that the overrunning one misses some. Prints
+// "dltest: OK" if all is well.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/procstat.h"
+#include "user/user.h"
+
+#define NNOISE  3
+#define NJOB    10
+#define RUNTIME 2
+#define PERIOD  5
+#define MAXPS   64
+
+static struct procstat ps[MAXPS];
+static int pertick;            // Spin loop iterations per tick
+
+static void
+fail(char *what)
+{
+  fprintf(2, "dltest: %s\n", what);
+  exit(1);
+}
+
+static void
+spin(int n)
+{
+  volatile int x = 0;
+  int i;
+
+  for(i = 0; i < n; i++)
+    x += i;
+}
+
+// Count how many spin iterations fit in a tick.
+static void
+calibrate(void)
+{
+  int t, n = 0;
+
+  t = uptime();
+  while(uptime() == t)
+    ;
+  t = uptime();
+  while(uptime() < t + 5){
+    spin(1000);
+    n += 1000;
+  }
+  pertick = n / 5;
+}
+
+// Deadlines the calling process has missed.
+static int
+misses(void)
+{
+  int i, n, pid = getpid();
+
+  if((n = procstat(ps, MAXPS)) < 0)
+    return -1;
+  for(i = 0; i < n; i++)
+    if(ps[i].pid == pid && ps[i].version == PROCSTAT_VERSION)
+      return ps[i].dlmisses;
+  return -1;
+}
+
+// A deadline process that runs NJOB jobs of work iterations,
+// telling the parent on fd whether it was admitted, and exits
+// with the number of deadlines it missed.
+static void
+periodic(int runtime, int work, int fd)
+{
+  int j;
+
+  if(sched_deadline(runtime, PERIOD, PERIOD) < 0){
+    write(fd, "n", 1);
+    exit(-1);
+  }
+  write(fd, "y", 1);
+  for(j = 0; j < NJOB; j++){
+    spin(work);
+    yield();
+  }
+  exit(misses());
+}
+
+int
+main(int argc, char *argv[])
+{
+  int noise[NNOISE], pid[3], fds[2];
+  int i, status;
+  char c;
+
+  calibrate();
+
+  for(i = 0; i < NNOISE; i++){
+    if((noise[i] = fork()) < 0)
+      fail("fork failed");
+    if(noise[i] == 0)
+      for(;;)
+        spin(pertick);
+  }
+
+  if(sched_deadline(0, PERIOD, PERIOD) != -1 ||
+     sched_deadline(RUNTIME, PERIOD, PERIOD + 1) != -1 ||
+     sched_deadline(PERIOD, PERIOD, PERIOD - 1) != -1)
+    fail("bad parameters accepted");
+
+  if(pipe(fds) < 0)
+    fail("pipe failed");
+  for(i = 0; i < 3; i++){
+    if((pid[i] = fork()) < 0)
+      fail("fork failed");
+    if(pid[i] == 0){
+      close(fds[0]);
+      if(i < 2)
+        periodic(RUNTIME, pertick / 2, fds[1]);
+      periodic(1, (PERIOD + 1) * pertick, fds[1]);
+    }
+    if(read(fds[0], &c, 1) != 1 || c != 'y')
+      fail("deadline process not admitted");
+  }
+
+  // 2/5 + 2/5 + 1/5 of the CPU is spoken for.
+  if(sched_deadline(1, PERIOD, PERIOD) != -1)
+    fail("over-committed set admitted");
+
+  for(i = 0; i < 3; i++){
+    if(waitpid(pid[i], &status, 0, 0) != pid[i])
+      fail("waitpid failed");
+    printf("dltest: process %d missed %d of %d deadlines\n", i, status, NJOB);
+    if(i < 2 && status != 0)
+      fail("feasible process missed deadlines");
+    if(i == 2 && status <= 0)
+      fail("overrunning process missed no deadlines");
+  }
+
+  for(i = 0; i < NNOISE; i++){
+    kill(noise[i]);
+    wait(0);
+  }
+  printf("dltest: OK\n");
+  exit(0);
+}
@@ -0,0 +1,102 @@
+// Check how fairly FAIR shares the CPU. Needs CPUS=1.
+//
+//   fairtest [nproc [ticks]]
+//
+// Forks nproc spinners with priorities 6, 10, 14, 18, 6, ...
+// that spin for the same number of ticks, and reads their
+// running time back with wait2(). Each spinner's running time
+// is divided by its weight, and Jain's fairness index of those
+// normalized shares,
+//
+//   J = (sum x)^2 / (n * sum x^2),
+//
+// is 1 when every process got exactly its weighted share and
+// 1/n when one process got everything. Prints it in thousandths
+// and checks that it is at least MINJAIN; prints
+// "fairtest: OK" if so. Runs under FAIR, and puts the old
+// policy back afterwards.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/policy.h"
+#include "kernel/schedtab.h"
+#include "user/user.h"
+
+#define MAXPROC 16
+#define MINJAIN 900            // Lowest passing index, in thousandths
+
+static int weights[20] = FAIRWEIGHTS;
+
+static void
+fail(char *what)
+{
+  fprintf(2, "fairtest: %s\n", what);
+  exit(1);
+}
+
+static void
+spin(int end)
+{
+  while(uptime() < end)
+    ;
+  exit(0);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int nproc = 4, ticks = 100;
+  int pid[MAXPROC], prio[MAXPROC];
+  int i, j, end, cpid, jain, old;
+  uint64 rutime[MAXPROC], retime, ru, stime, x, sum, sumsq;
+
+  if(argc > 1)
+    nproc = atoi(argv[1]);
+  if(argc > 2)
+    ticks = atoi(argv[2]);
+  if(nproc < 1 || nproc > MAXPROC || ticks < 1){
+    fprintf(2, "usage: fairtest [nproc [ticks]], nproc <= %d\n", MAXPROC);
+    exit(1);
+  }
+  if((old = setsched(SCHED_FAIR)) < 0)
+    fail("setsched failed");
+
+  end = uptime() + ticks;
+  for(i = 0; i < nproc; i++){
+    prio[i] = 6 + 4 * (i % 4);
+    pid[i] = fork();
+    if(pid[i] < 0)
+      fail("fork failed");
+    if(pid[i] == 0)
+      spin(end);
+    chpr(pid[i], prio[i]);
+    rutime[i] = 0;
+  }
+
+  for(i = 0; i < nproc; i++){
+    cpid = wait2(&retime, &ru, &stime);
+    for(j = 0; j < nproc; j++)
+      if(pid[j] == cpid)
+        rutime[j] = ru;
+  }
+  setsched(old);
+
+  // x is running time per unit of weight. rutime is in
+  // cycles; scale it down first so that sum * sum fits.
+  sum = sumsq = 0;
+  for(i = 0; i < nproc; i++){
+    x = rutime[i] / 1000 * NICE0 / weights[prio[i] - 1];
+    sum += x;
+    sumsq += x * x;
+    printf("fairtest pid %d priority %d weight %d rutime %lu\n",
+           pid[i], prio[i], weights[prio[i] - 1], rutime[i]);
+  }
+  if(sumsq == 0)
+    fail("the spinners did not run");
+  jain = (int)(sum * sum * 1000 / (nproc * sumsq));
+  printf("fairtest nproc=%d ticks=%d jain=%d/1000\n", nproc, ticks, jain);
+  if(jain < MINJAIN)
+    fail("index not within tolerance");
+  printf("fairtest: OK\n");
+  exit(0);
+}
@@ -1,11 +1,12 @@
 // Test that fork fails gracefully.
 // Tiny executable so that the limit can be filling the proc table.
 
+#include "kernel/param.h"
 #include "kernel/types.h"
 #include "kernel/stat.h"
 #include "user/user.h"
 
-#define N  1000
+#define N  (NPROC + 1)  // one more than there can be slots
 
 void
 print(const char *s)
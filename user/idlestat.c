@@ -0,0 +1,55 @@
+// Show how busy each CPU is.
+//
+//   idlestat [ticks]
+//
+// Reads the kernel's per-CPU idle time twice, ticks apart
+// (default 10), and prints the fraction of that interval each
+// CPU spent running something, and the average over all CPUs.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/param.h"
+#include "kernel/idlestat.h"
+#include "user/user.h"
+
+int
+main(int argc, char *argv[])
+{
+  struct idlestat a, b;
+  uint64 span, idle, busy, sumspan, sumbusy;
+  int ticks = 10;
+  int i;
+
+  if(argc > 1)
+    ticks = atoi(argv[1]);
+  if(ticks < 1){
+    fprintf(2, "usage: idlestat [ticks]\n");
+    exit(1);
+  }
+
+  if(idlestat(&a) < 0){
+    fprintf(2, "idlestat: idlestat failed\n");
+    exit(1);
+  }
+  sleep(ticks);
+  idlestat(&b);
+
+  sumspan = sumbusy = 0;
+  for(i = 0; i < NCPU; i++){
+    if(b.online[i] == 0)
+      continue;
+    // a CPU that came online during the interval counts from then.
+    span = b.now - (a.online[i] ? a.now : b.online[i]);
+    idle = b.idle[i] - a.idle[i];
+    if(idle > span)
+      idle = span;
+    busy = span - idle;
+    sumspan += span;
+    sumbusy += busy;
+    printf("cpu%d busy %d%% idle %lu cycles\n", i,
+           span ? (int)(busy * 100 / span) : 0, idle);
+  }
+  printf("all busy %d%% over %d ticks\n",
+         sumspan ? (int)(sumbusy * 100 / sumspan) : 0, ticks);
+  exit(0);
+}
@@ -0,0 +1,108 @@
+// Check LOTTERY ticket currencies. Needs CPUS=1.
+//
+//   lotterytest [members [ticks]]
+//
+// A currency funded with N base tickets is shared by several
+// spinning children, while one spinner outside it holds N base
+// tickets of its own. Every spinner counts loop iterations for
+// the same number of ticks under LOTTERY. The group as a whole
+// and the lone spinner should each get about half the work
+// done, however many members the group has; checks that each
+// got between LOW and HIGH percent of it. Prints
+// "lotterytest: OK" if so.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/policy.h"
+#include "user/user.h"
+
+#define FUNDING 30
+#define LOW     30
+#define HIGH    70
+
+static void
+fail(char *what)
+{
+  fprintf(2, "lotterytest: %s\n", what);
+  exit(1);
+}
+
+// Spin until tick end, then exit with the number of
+// iterations done, in thousands.
+static void
+spin(int end)
+{
+  int n = 0;
+  volatile int i;
+
+  while(uptime() < end){
+    for(i = 0; i < 1000; i++)
+      ;
+    n++;
+  }
+  exit(n);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int members = 3, ticks = 50;
+  int i, end, lone, group, cur, n, status, old;
+  int lonework = 0, groupwork = 0;
+
+  if(argc > 1)
+    members = atoi(argv[1]);
+  if(argc > 2)
+    ticks = atoi(argv[2]);
+  if((old = setsched(SCHED_LOTTERY)) < 0)
+    fail("setsched failed");
+  end = uptime() + ticks;
+
+  lone = fork();
+  if(lone == 0)
+    spin(end);
+  chtickets(lone, FUNDING);
+
+  // the group is forked from a child, so that this
+  // process's own tickets stay out of the currency.
+  group = fork();
+  if(group == 0){
+    if((cur = mkcurrency(FUNDING)) < 0){
+      fprintf(2, "lotterytest: mkcurrency failed\n");
+      exit(-1);
+    }
+    for(i = 0; i < members; i++)
+      if(fork() == 0)
+        spin(end);
+    // don't lend the group extra tickets while waiting.
+    chtickets(getpid(), 0);
+    n = 0;
+    for(i = 0; i < members; i++){
+      wait(&status);
+      n += status;
+    }
+    exit(n);
+  }
+
+  for(i = 0; i < 2; i++){
+    int pid = wait(&status);
+    if(pid == lone){
+      lonework = status;
+      printf("lotterytest: lone process, %d tickets: %d\n", FUNDING, status);
+    } else if(pid == group){
+      groupwork = status;
+      printf("lotterytest: currency funded %d, %d members: %d\n",
+             FUNDING, members, status);
+    }
+  }
+  setsched(old);
+
+  n = lonework + groupwork;
+  if(lonework <= 0 || groupwork <= 0)
+    fail("a spinner did no work");
+  if((uint64)lonework * 100 < (uint64)n * LOW ||
+     (uint64)lonework * 100 > (uint64)n * HIGH)
+    fail("split not within tolerance");
+  printf("lotterytest: OK\n");
+  exit(0);
+}
@@ -0,0 +1,90 @@
+// Pid lookup benchmark.
+//
+//   pidbench [maxproc [calls]]
+//
+// For nproc = 1, 2, 4, ... maxproc, forks nproc children that
+// block reading a pipe, then times calls chpr()s spread over
+// the children and calls kill()s of a pid that doesn't exist,
+// which is the worst case for a lookup. Prints one line per
+// process count with the number of calls per clock tick, which
+// should stay flat as nproc grows.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "user/user.h"
+
+#define MAXPROC 48
+#define NOPID 0x7fffffff
+
+static void
+report(char *name, int nproc, int calls, int ticks)
+{
+  if(ticks == 0)
+    ticks = 1;
+  printf("pidbench %s nproc=%d calls=%d ticks=%d calls/tick=%d\n",
+         name, nproc, calls, ticks, calls / ticks);
+}
+
+static void
+bench(int nproc, int calls)
+{
+  int pid[MAXPROC];
+  int fds[2];
+  int i, t0;
+  char c;
+
+  if(pipe(fds) < 0){
+    fprintf(2, "pidbench: pipe failed\n");
+    exit(1);
+  }
+  for(i = 0; i < nproc; i++){
+    pid[i] = fork();
+    if(pid[i] < 0){
+      fprintf(2, "pidbench: fork failed\n");
+      exit(1);
+    }
+    if(pid[i] == 0){
+      close(fds[1]);
+      read(fds[0], &c, 1);
+      exit(0);
+    }
+  }
+  close(fds[0]);
+
+  t0 = uptime();
+  for(i = 0; i < calls; i++)
+    chpr(pid[i % nproc], 10);
+  report("chpr", nproc, calls, uptime() - t0);
+
+  t0 = uptime();
+  for(i = 0; i < calls; i++)
+    kill(NOPID);
+  report("kill", nproc, calls, uptime() - t0);
+
+  // the children see end of file and exit.
+  close(fds[1]);
+  for(i = 0; i < nproc; i++)
+    wait(0);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int maxproc = 32;
+  int calls = 100000;
+  int n;
+
+  if(argc > 1)
+    maxproc = atoi(argv[1]);
+  if(argc > 2)
+    calls = atoi(argv[2]);
+  if(maxproc < 1 || maxproc > MAXPROC || calls < 1){
+    fprintf(2, "usage: pidbench [maxproc [calls]], maxproc <= %d\n", MAXPROC);
+    exit(1);
+  }
+
+  for(n = 1; n < maxproc; n *= 2)
+    bench(n, calls);
+  bench(maxproc, calls);
+  exit(0);
+}
@@ -0,0 +1,60 @@
+// Test procstat().
+//
+//   pstest
+//
+// Takes NCALL procstat() snapshots, as top does while it runs,
+// and checks that each finds this process and that the number
+// of free pages of physical memory is the same afterwards, so
+// the kernel's snapshot buffer isn't leaked. Prints
+// "pstest: OK" if all is well.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/procstat.h"
+#include "user/user.h"
+
+#define NCALL  200
+#define MAXPS  64
+
+static struct procstat ps[MAXPS];
+
+static void
+fail(char *what)
+{
+  fprintf(2, "pstest: %s\n", what);
+  exit(1);
+}
+
+// Take a snapshot and check that it has this process in it.
+static void
+snapshot(int pid)
+{
+  int i, n;
+
+  if((n = procstat(ps, MAXPS)) <= 0)
+    fail("procstat failed");
+  for(i = 0; i < n; i++)
+    if(ps[i].pid == pid && ps[i].version == PROCSTAT_VERSION)
+      return;
+  fail("procstat didn't report this process");
+}
+
+int
+main(int argc, char *argv[])
+{
+  int i, pid = getpid(), before, after;
+
+  // the first call may fault in ps's pages.
+  snapshot(pid);
+  before = freemem();
+  for(i = 0; i < NCALL; i++)
+    snapshot(pid);
+  after = freemem();
+  if(after != before){
+    printf("pstest: %d free pages before, %d after %d calls\n",
+           before, after, NCALL);
+    fail("procstat leaks memory");
+  }
+  printf("pstest: OK\n");
+  exit(0);
+}
@@ -0,0 +1,93 @@
+// Check how quickly an interactive process gets the CPU back
+// while CPU hogs are running. Needs CPUS=1.
+//
+//   resptest [hogs [rounds]]
+//
+// Forks hogs spinning children, then sleeps for one tick
+// rounds times, each time measuring how many ticks late it
+// got to run again after its sleep ended. Does this under
+// round robin and then under MLFQ, putting the old policy back
+// afterwards. Round robin makes the sleeper wait behind the
+// hogs, while MLFQ should let it run straight away, except
+// just after a boost; checks that MLFQ's average lateness is
+// at most half of round robin's. Prints "resptest: OK" if so.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/policy.h"
+#include "user/user.h"
+
+#define MAXHOGS 16
+
+static void
+fail(char *what)
+{
+  fprintf(2, "resptest: %s\n", what);
+  exit(1);
+}
+
+// Run the rounds under policy with hogs hogs, and return the
+// average lateness in hundredths of a tick.
+static int
+measure(int policy, char *name, int hogs, int rounds)
+{
+  int pid[MAXHOGS];
+  int i, t, late, total, worst;
+
+  if(setsched(policy) < 0)
+    fail("setsched failed");
+  for(i = 0; i < hogs; i++){
+    pid[i] = fork();
+    if(pid[i] < 0)
+      fail("fork failed");
+    if(pid[i] == 0)
+      for(;;)
+        ;
+  }
+
+  total = worst = 0;
+  for(i = 0; i < rounds; i++){
+    t = uptime();
+    sleep(1);
+    // sleep(1) ends at the next tick, t + 1.
+    late = uptime() - (t + 1);
+    total += late;
+    if(late > worst)
+      worst = late;
+  }
+
+  for(i = 0; i < hogs; i++){
+    kill(pid[i]);
+    wait(0);
+  }
+  printf("resptest %s hogs=%d rounds=%d late avg=%d/100 max=%d ticks\n",
+         name, hogs, rounds, total * 100 / rounds, worst);
+  return total * 100 / rounds;
+}
+
+int
+main(int argc, char *argv[])
+{
+  int hogs = 4, rounds = 50;
+  int old, rr, mlfq;
+
+  if(argc > 1)
+    hogs = atoi(argv[1]);
+  if(argc > 2)
+    rounds = atoi(argv[2]);
+  if(hogs < 0 || hogs > MAXHOGS || rounds < 1){
+    fprintf(2, "usage: resptest [hogs [rounds]], hogs <= %d\n", MAXHOGS);
+    exit(1);
+  }
+
+  if((old = setsched(-1)) < 0)
+    fail("setsched failed");
+  rr = measure(SCHED_DEFAULT, "default", hogs, rounds);
+  mlfq = measure(SCHED_MLFQ, "mlfq", hogs, rounds);
+  setsched(old);
+
+  if(mlfq * 2 > rr)
+    fail("mlfq not within tolerance");
+  printf("resptest: OK\n");
+  exit(0);
+}
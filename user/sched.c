@@ -0,0 +1,49 @@
+// Show or switch the scheduling policy.
+//
+//   sched            print the current policy
+//   sched policy     switch to policy
+//
+// Processes that are already runnable move to the new policy
+// straight away, so the same workload can be run under
+// several policies without rebooting.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/policy.h"
+#include "kernel/schedtab.h"
+#include "user/user.h"
+
+static char *names[] = SCHEDNAMES;
+
+#define NPOLICY (sizeof(names) / sizeof(names[0]))
+
+int
+main(int argc, char *argv[])
+{
+  int i, old;
+
+  if(argc < 2){
+    old = setsched(-1);
+    printf("%s\n", old >= 0 && old < NPOLICY ? names[old] : "?");
+    exit(0);
+  }
+
+  for(i = 0; i < NPOLICY; i++)
+    if(strcmp(argv[1], names[i]) == 0)
+      break;
+  if(i == NPOLICY){
+    fprintf(2, "usage: sched [");
+    for(i = 0; i < NPOLICY; i++)
+      fprintf(2, "%s%s", i ? "|" : "", names[i]);
+    fprintf(2, "]\n");
+    exit(1);
+  }
+
+  old = setsched(i);
+  if(old < 0){
+    fprintf(2, "sched: setsched %s failed\n", argv[1]);
+    exit(1);
+  }
+  printf("sched: %s -> %s\n", names[old], names[i]);
+  exit(0);
+}
@@ -0,0 +1,232 @@
+// Scheduler benchmark: the RISC-V successor of
+// lab_scheduling/end/sanity.c and SMLsanity.c.
+//
+//   schedbench [cpu|io|mixed [nproc [work [runs]]]]
+//
+// Each run forks nproc children doing the same kind of work
+// and reaps them with wait2():
+//  - cpu: spins for work units;
+//  - io: work rounds of a little computation and a byte sent
+//    back and forth with a partner over a pair of pipes, and a
+//    one-tick sleep every tenth round (a child without a
+//    partner sleeps every round);
+//  - mixed: children take turns being cpu, io and short cpu,
+//    which spins one unit at a time and yields in between.
+// For each run prints one line with the policy, the elapsed
+// ticks, the throughput in jobs per minute, the mean, 90th
+// percentile and worst turnaround in cycles, and Jain's
+// fairness index, in thousandths, of the fraction of its
+// turnaround each child spent running. Switch policies with
+// "sched" between runs to compare them on the same workload.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/policy.h"
+#include "kernel/schedtab.h"
+#include "user/user.h"
+
+#define MAXPROC 32
+#define UNIT 100000            // Loop iterations per unit of work
+
+// Kinds of child, and workloads.
+#define CPU    0
+#define IO     1
+#define SHORT  2
+#define MIXED  3
+
+static char *policies[] = SCHEDNAMES;
+
+#define NPOLICY (sizeof(policies) / sizeof(policies[0]))
+
+static void
+spin(int units)
+{
+  volatile int x = 0;
+  int i;
+
+  for(i = 0; i < units * UNIT; i++)
+    x += i;
+}
+
+// An io child sends to its partner on fd to and listens on fd
+// from; to is -1 if it has no partner.
+static void
+io(int rounds, int to, int from)
+{
+  char c = 0;
+  int i;
+
+  for(i = 0; i < rounds; i++){
+    spin(1);
+    if(to < 0){
+      sleep(1);
+      continue;
+    }
+    write(to, &c, 1);
+    read(from, &c, 1);
+    if(i % 10 == 9)
+      sleep(1);
+  }
+}
+
+static void
+child(int kind, int work, int to, int from)
+{
+  int i;
+
+  switch(kind){
+  case CPU:
+    spin(work);
+    break;
+  case IO:
+    io(work, to, from);
+    break;
+  case SHORT:
+    for(i = 0; i < work; i++){
+      spin(1);
+      yield();
+    }
+    break;
+  }
+  exit(0);
+}
+
+// The kind of child i in a workload.
+static int
+kindof(int workload, int i)
+{
+  if(workload == MIXED)
+    return i % 3;
+  return workload;
+}
+
+static void
+run(int workload, char *wname, int nproc, int work)
+{
+  int pid[MAXPROC], kind[MAXPROC], peer[MAXPROC];
+  int fds[2][2];
+  uint64 turn[MAXPROC], ru[MAXPROC];
+  uint64 retime, rutime, stime, t, sum, x, xsum, xsq;
+  int i, j, cpid, t0, ticks, old;
+
+  // pair up the io children: each writes to its partner's pipe.
+  for(i = 0; i < nproc; i++){
+    kind[i] = kindof(workload, i);
+    peer[i] = -1;
+  }
+  for(i = 0; i < nproc; i++){
+    if(kind[i] != IO || peer[i] >= 0)
+      continue;
+    for(j = i + 1; j < nproc; j++)
+      if(kind[j] == IO && peer[j] < 0)
+        break;
+    if(j < nproc){
+      peer[i] = j;
+      peer[j] = i;
+    }
+  }
+  // the partners of a pair are the next two io children, so
+  // only one pair's pipes are open at a time: fds[0] carries
+  // bytes to the first partner, fds[1] to the second.
+  t0 = uptime();
+  for(i = 0; i < nproc; i++){
+    if(kind[i] == IO && peer[i] > i && (pipe(fds[0]) < 0 || pipe(fds[1]) < 0)){
+      fprintf(2, "schedbench: pipe failed\n");
+      exit(1);
+    }
+    pid[i] = fork();
+    if(pid[i] < 0){
+      fprintf(2, "schedbench: fork failed\n");
+      exit(1);
+    }
+    if(pid[i] == 0){
+      if(kind[i] == IO && peer[i] > i)
+        child(IO, work, fds[1][1], fds[0][0]);
+      if(kind[i] == IO && peer[i] >= 0)
+        child(IO, work, fds[0][1], fds[1][0]);
+      child(kind[i], work, -1, -1);
+    }
+    if(kind[i] == IO && peer[i] >= 0 && peer[i] < i){
+      for(j = 0; j < 2; j++){
+        close(fds[j][0]);
+        close(fds[j][1]);
+      }
+    }
+  }
+
+  for(i = 0; i < nproc; i++){
+    cpid = wait2(&retime, &rutime, &stime);
+    for(j = 0; j < nproc; j++){
+      if(pid[j] == cpid){
+        turn[j] = retime + rutime + stime;
+        ru[j] = rutime;
+      }
+    }
+  }
+  ticks = uptime() - t0;
+  if(ticks == 0)
+    ticks = 1;
+
+  // x is the fraction of its turnaround each child ran, in
+  // thousandths.
+  sum = xsum = xsq = 0;
+  for(i = 0; i < nproc; i++){
+    sum += turn[i];
+    x = turn[i] ? ru[i] * 1000 / turn[i] : 0;
+    xsum += x;
+    xsq += x * x;
+  }
+  if(xsq == 0)
+    xsq = 1;
+
+  // sort the turnarounds for the percentile.
+  for(i = 1; i < nproc; i++){
+    t = turn[i];
+    for(j = i; j > 0 && turn[j - 1] > t; j--)
+      turn[j] = turn[j - 1];
+    turn[j] = t;
+  }
+
+  old = setsched(-1);
+  printf("schedbench policy=%s workload=%s nproc=%d work=%d ticks=%d "
+         "jobs/min=%d mean=%lu p90=%lu max=%lu jain=%d/1000\n",
+         old >= 0 && old < NPOLICY ? policies[old] : "?",
+         wname, nproc, work, ticks, nproc * 600 / ticks,
+         sum / nproc, turn[nproc * 9 / 10],
+         turn[nproc - 1], (int)(xsum * xsum * 1000 / (nproc * xsq)));
+}
+
+int
+main(int argc, char *argv[])
+{
+  char *wname = "mixed";
+  int workload, nproc = 9, work = 50, runs = 1;
+  int r;
+
+  if(argc > 1)
+    wname = argv[1];
+  if(argc > 2)
+    nproc = atoi(argv[2]);
+  if(argc > 3)
+    work = atoi(argv[3]);
+  if(argc > 4)
+    runs = atoi(argv[4]);
+
+  if(strcmp(wname, "cpu") == 0)
+    workload = CPU;
+  else if(strcmp(wname, "io") == 0)
+    workload = IO;
+  else if(strcmp(wname, "mixed") == 0)
+    workload = MIXED;
+  else
+    workload = -1;
+  if(workload < 0 || nproc < 1 || nproc > MAXPROC || work < 1 || runs < 1){
+    fprintf(2, "usage: schedbench [cpu|io|mixed [nproc [work [runs]]]], nproc <= %d\n",
+            MAXPROC);
+    exit(1);
+  }
+
+  for(r = 0; r < runs; r++)
+    run(workload, wname, nproc, work);
+  exit(0);
+}
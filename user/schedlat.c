@@ -0,0 +1,111 @@
+// Show scheduler latency percentiles.
+//
+//   schedlat [ticks]
+//
+// Reads the kernel's latency histograms (see kernel/schedlat.h)
+// and prints the 50th, 99th and 99.9th percentiles of the run
+// queue wait, the wakeup latency and the slice length, in
+// cycles, once per policy that has run anything and once per
+// CPU. A percentile is shown as the upper bound of the log2
+// bucket it falls in. With ticks, only counts what happens
+// over the next ticks clock ticks.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/param.h"
+#include "kernel/policy.h"
+#include "kernel/schedtab.h"
+#include "kernel/schedlat.h"
+#include "user/user.h"
+
+static char *policies[] = SCHEDNAMES;
+
+static char *kinds[] = {
+[LAT_QUEUE]  "queue",
+[LAT_WAKEUP] "wakeup",
+[LAT_SLICE]  "slice",
+};
+
+static struct schedlat a, b;
+
+// The upper bound of the bucket holding the q/1000 quantile
+// of h, which holds n samples.
+static uint64
+quantile(uint64 *h, uint64 n, int q)
+{
+  uint64 sum = 0;
+  int i;
+
+  for(i = 0; i < NLATBUCKET - 1; i++){
+    sum += h[i];
+    if(sum * 1000 >= n * q)
+      break;
+  }
+  return i == 0 ? 0 : (1UL << i) - 1;
+}
+
+// Print one line for histogram h of kind k, labelled with a
+// policy name, or with cpu if name is 0.
+static void
+report(char *name, int cpu, int k, uint64 *h)
+{
+  uint64 n = 0;
+  int i;
+
+  for(i = 0; i < NLATBUCKET; i++)
+    n += h[i];
+  if(n == 0)
+    return;
+  if(name)
+    printf("schedlat policy=%s", name);
+  else
+    printf("schedlat cpu=%d", cpu);
+  printf(" kind=%s n=%lu p50=%lu p99=%lu p999=%lu\n", kinds[k], n,
+         quantile(h, n, 500), quantile(h, n, 990), quantile(h, n, 999));
+}
+
+int
+main(int argc, char *argv[])
+{
+  uint64 h[NLATBUCKET];
+  int ticks = 0;
+  int cpu, pol, k, i;
+
+  if(argc > 1)
+    ticks = atoi(argv[1]);
+  if(ticks < 0){
+    fprintf(2, "usage: schedlat [ticks]\n");
+    exit(1);
+  }
+
+  // without ticks, a stays zero and everything since boot counts.
+  if(ticks > 0){
+    if(schedlat(&a) < 0){
+      fprintf(2, "schedlat: schedlat failed\n");
+      exit(1);
+    }
+    sleep(ticks);
+  }
+  if(schedlat(&b) < 0){
+    fprintf(2, "schedlat: schedlat failed\n");
+    exit(1);
+  }
+
+  for(k = 0; k < NLAT; k++){
+    for(pol = 0; pol < NSCHED; pol++){
+      memset(h, 0, sizeof(h));
+      for(cpu = 0; cpu < NCPU; cpu++)
+        for(i = 0; i < NLATBUCKET; i++)
+          h[i] += b.count[cpu][pol][k][i] - a.count[cpu][pol][k][i];
+      report(policies[pol], 0, k, h);
+    }
+    for(cpu = 0; cpu < NCPU; cpu++){
+      memset(h, 0, sizeof(h));
+      for(pol = 0; pol < NSCHED; pol++)
+        for(i = 0; i < NLATBUCKET; i++)
+          h[i] += b.count[cpu][pol][k][i] - a.count[cpu][pol][k][i];
+      report(0, cpu, k, h);
+    }
+  }
+  exit(0);
+}
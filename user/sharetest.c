@@ -0,0 +1,139 @@
+// Compare how evenly LOTTERY and STRIDE share the CPU.
+// Needs CPUS=1.
+//
+//   sharetest [runs [ticks]]
+//
+// Each run forks three spinners holding 1, 2 and 3 tickets that
+// spin for the same number of ticks, and reads their running
+// time back with wait2(). Every spinner should get its ticket
+// share of the time, i.e. 1/6, 2/6 and 3/6. Does the runs under
+// LOTTERY and then under STRIDE, putting the old policy back
+// afterwards. Prints each run's shares in thousandths, then for
+// each policy the mean squared error from the ideal shares over
+// all runs. Checks that each spinner's share of all the runs
+// together is within the policy's tolerance of its ideal share:
+// STRIDE is deterministic, so its tolerance is much tighter.
+// Prints "sharetest: OK" if so.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/policy.h"
+#include "kernel/schedtab.h"
+#include "user/user.h"
+
+#define NSPIN 3
+
+static char *names[] = SCHEDNAMES;
+
+// Tolerance of the overall shares, in thousandths.
+static struct {
+  int policy;
+  int tol;
+} tests[] = {
+  { SCHED_LOTTERY, 100 },
+  { SCHED_STRIDE,  30 },
+};
+
+static void
+fail(char *what)
+{
+  fprintf(2, "sharetest: %s\n", what);
+  exit(1);
+}
+
+static void
+spin(int end)
+{
+  while(uptime() < end)
+    ;
+  exit(0);
+}
+
+// Do the runs under the current policy, called name, and check
+// the overall shares against tol.
+static void
+measure(char *name, int tol, int runs, int ticks)
+{
+  int pid[NSPIN];
+  int r, i, j, end, share, err, sqerr, n, cpid;
+  uint64 rutime[NSPIN], all[NSPIN], total, sum, retime, ru, stime;
+
+  sqerr = 0;
+  n = 0;
+  sum = 0;
+  for(i = 0; i < NSPIN; i++)
+    all[i] = 0;
+  for(r = 0; r < runs; r++){
+    end = uptime() + ticks;
+    for(i = 0; i < NSPIN; i++){
+      pid[i] = fork();
+      if(pid[i] < 0)
+        fail("fork failed");
+      if(pid[i] == 0)
+        spin(end);
+      chtickets(pid[i], i + 1);
+      rutime[i] = 0;
+    }
+
+    total = 0;
+    for(i = 0; i < NSPIN; i++){
+      cpid = wait2(&retime, &ru, &stime);
+      for(j = 0; j < NSPIN; j++)
+        if(pid[j] == cpid)
+          rutime[j] = ru;
+      total += ru;
+    }
+    if(total == 0)
+      total = 1;
+
+    printf("sharetest %s run %d:", name, r);
+    for(i = 0; i < NSPIN; i++){
+      share = (int)(rutime[i] * 1000 / total);
+      err = share - (i + 1) * 1000 / 6;
+      sqerr += err * err;
+      n++;
+      all[i] += rutime[i];
+      printf(" %d", share);
+    }
+    sum += total;
+    printf("\n");
+  }
+  printf("sharetest %s ideal: %d %d %d mse=%d\n",
+         name, 1000 / 6, 2000 / 6, 3000 / 6, sqerr / n);
+
+  for(i = 0; i < NSPIN; i++){
+    err = (int)(all[i] * 1000 / sum) - (i + 1) * 1000 / 6;
+    if(err < -tol || err > tol)
+      fail("share not within tolerance");
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  int runs = 5, ticks = 100;
+  int t, old;
+
+  if(argc > 1)
+    runs = atoi(argv[1]);
+  if(argc > 2)
+    ticks = atoi(argv[2]);
+  if(runs < 1 || ticks < 1){
+    fprintf(2, "usage: sharetest [runs [ticks]]\n");
+    exit(1);
+  }
+
+  // don't lend the spinners extra tickets while waiting.
+  chtickets(getpid(), 0);
+
+  if((old = setsched(-1)) < 0)
+    fail("setsched failed");
+  for(t = 0; t < sizeof(tests) / sizeof(tests[0]); t++){
+    if(setsched(tests[t].policy) < 0)
+      fail("setsched failed");
+    measure(names[tests[t].policy], tests[t].tol, runs, ticks);
+  }
+  setsched(old);
+  printf("sharetest: OK\n");
+  exit(0);
+}
@@ -6,7 +6,7 @@ int
 main(int argc, char *argv[])
 {
     int pid;
-    int retime, rutime, stime;
+    uint64 retime, rutime, stime;
     
     fprintf(1, "Simple test for wait2 system call...\n");
     
@@ -22,7 +22,7 @@ main(int argc, char *argv[])
         fprintf(1, "Parent waiting for child...\n");
         int result = wait2(&retime, &rutime, &stime);
         fprintf(1, "wait2 returned: %d\n", result);
-        fprintf(1, "Statistics: ready=%d, running=%d, sleeping=%d\n", 
+        fprintf(1, "Statistics: ready=%lu, running=%lu, sleeping=%lu cycles\n", 
                 retime, rutime, stime);
     }
     
@@ -3,9 +3,9 @@
 #include "user/user.h"
 
 void
-print_stats(int pid, int retime, int rutime, int stime)
+print_stats(int pid, uint64 retime, uint64 rutime, uint64 stime)
 {
-    fprintf(1, "PID: %d, Ready: %d, Running: %d, Sleeping: %d\n", 
+    fprintf(1, "PID: %d, Ready: %lu, Running: %lu, Sleeping: %lu cycles\n", 
            pid, retime, rutime, stime);
 }
 
@@ -13,8 +13,8 @@ int
 main(int argc, char *argv[])
 {
     int pid1, pid2;
-    int retime1, rutime1, stime1;
-    int retime2, rutime2, stime2;
+    uint64 retime1, rutime1, stime1;
+    uint64 retime2, rutime2, stime2;
     
     fprintf(1, "Testing scheduling algorithms...\n");
     
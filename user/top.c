@@ -0,0 +1,100 @@
+// Show what the processes are doing.
+//
+//   top [ticks [rounds]]
+//
+// Every ticks clock ticks (default 10) takes a procstat()
+// snapshot and prints each live process: its state, the CPU
+// and policy it last ran under, how much of one CPU it ran for
+// since the previous snapshot, its resident pages and page
+// faults. Stops after rounds snapshots, or runs until killed
+// if rounds is 0 (the default).
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/param.h"
+#include "kernel/policy.h"
+#include "kernel/schedtab.h"
+#include "kernel/procstat.h"
+#include "user/user.h"
+
+#define MAXPS 128
+
+static char *states[] = { "unused", "used", "sleep", "runble", "run", "zombie" };
+
+static char *policies[] = SCHEDNAMES;
+
+#define NSTATE (sizeof(states) / sizeof(states[0]))
+#define NPOLICY (sizeof(policies) / sizeof(policies[0]))
+
+static struct procstat cur[MAXPS], prev[MAXPS];
+
+// Running time of pid in the previous snapshot, 0 if it
+// wasn't there.
+static uint64
+prevrutime(int pid, int nprev)
+{
+  int i;
+
+  for(i = 0; i < nprev; i++)
+    if(prev[i].pid == pid)
+      return prev[i].rutime;
+  return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+  int ticks = 10, rounds = 0;
+  int r, i, n, nprev, t, t0;
+  uint64 span, ran;
+  struct procstat *ps;
+
+  if(argc > 1)
+    ticks = atoi(argv[1]);
+  if(argc > 2)
+    rounds = atoi(argv[2]);
+  if(ticks < 1 || rounds < 0){
+    fprintf(2, "usage: top [ticks [rounds]]\n");
+    exit(1);
+  }
+
+  if((nprev = procstat(prev, MAXPS)) < 0){
+    fprintf(2, "top: procstat failed\n");
+    exit(1);
+  }
+  t0 = uptime();
+  for(r = 0; rounds == 0 || r < rounds; r++){
+    sleep(ticks);
+    if((n = procstat(cur, MAXPS)) < 0){
+      fprintf(2, "top: procstat failed\n");
+      exit(1);
+    }
+    t = uptime();
+    span = (uint64)(t - t0) * QUANTUM;
+    if(span == 0)
+      span = 1;
+
+    printf("\npid ppid state cpu policy prio %%cpu rss faults name\n");
+    for(i = 0; i < n; i++){
+      ps = &cur[i];
+      if(ps->version != PROCSTAT_VERSION){
+        fprintf(2, "top: procstat version %d, want %d\n",
+                ps->version, PROCSTAT_VERSION);
+        exit(1);
+      }
+      ran = ps->rutime - prevrutime(ps->pid, nprev);
+      printf("%d %d %s %d %s %d %d%% %lu %lu %s\n",
+             ps->pid, ps->ppid,
+             ps->state >= 0 && ps->state < NSTATE ? states[ps->state] : "?",
+             ps->cpu,
+             ps->policy >= 0 && ps->policy < NPOLICY ? policies[ps->policy] : "-",
+             ps->priority, (int)(ran * 100 / span),
+             ps->rss, ps->pgfaults, ps->name);
+    }
+
+    memmove(prev, cur, n * sizeof(cur[0]));
+    nprev = n;
+    t0 = t;
+  }
+  exit(0);
+}
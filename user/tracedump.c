@@ -0,0 +1,83 @@
+// Control scheduler tracing and dump the trace.
+//
+//   tracedump on       start tracing
+//   tracedump off      stop tracing
+//   tracedump          print the trace
+//
+// The trace is printed in the Trace Event Format that Chrome's
+// about:tracing and Perfetto load: one row per CPU, a slice for
+// each time a process ran there, and instant events for
+// wakeups, forks, exits and migrations. Redirect it to a file,
+// e.g. "tracedump > trace.json". Each CPU keeps its last
+// NTRACE events.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/param.h"
+#include "kernel/trace.h"
+#include "user/user.h"
+
+static char *names[] = {
+[TRACE_SWITCHIN]  "run",
+[TRACE_SWITCHOUT] "run",
+[TRACE_WAKEUP]    "wakeup",
+[TRACE_FORK]      "fork",
+[TRACE_EXIT]      "exit",
+[TRACE_MIGRATE]   "migrate",
+};
+
+static struct tracering rings[NCPU];
+
+int
+main(int argc, char *argv[])
+{
+  struct tracering *r;
+  struct traceevent *e;
+  uint64 i, start, us;
+  int cpu, first;
+  char *ph;
+
+  if(argc > 1){
+    if(strcmp(argv[1], "on") == 0)
+      settrace(1);
+    else if(strcmp(argv[1], "off") == 0)
+      settrace(0);
+    else {
+      fprintf(2, "usage: tracedump [on|off]\n");
+      exit(1);
+    }
+    exit(0);
+  }
+
+  if(traceread(rings) < 0){
+    fprintf(2, "tracedump: traceread failed\n");
+    exit(1);
+  }
+
+  // timestamps are in microseconds; QUANTUM cycles are 0.1s.
+  first = 1;
+  printf("{\"traceEvents\":[\n");
+  for(cpu = 0; cpu < NCPU; cpu++){
+    r = &rings[cpu];
+    start = r->head > NTRACE ? r->head - NTRACE : 0;
+    for(i = start; i < r->head; i++){
+      e = &r->ev[i % NTRACE];
+      if(e->type < TRACE_SWITCHIN || e->type > TRACE_MIGRATE)
+        continue;
+      if(e->type == TRACE_SWITCHIN)
+        ph = "\"B\"";
+      else if(e->type == TRACE_SWITCHOUT)
+        ph = "\"E\"";
+      else
+        ph = "\"i\",\"s\":\"t\"";
+      us = e->time / (QUANTUM / 100000);
+      printf("%s{\"name\":\"%s %d\",\"ph\":%s,\"pid\":0,\"tid\":%d,\"ts\":%lu,"
+             "\"args\":{\"from\":%d,\"to\":%d}}",
+             first ? "" : ",\n", names[e->type], e->pid, ph, cpu, us,
+             e->from, e->to);
+      first = 0;
+    }
+  }
+  printf("\n]}\n");
+  exit(0);
+}
@@ -1,4 +1,9 @@
 struct stat;
+struct idlestat;
+struct procstat;
+struct rusage;
+struct schedlat;
+struct tracering;
 
 // system calls
 int fork(void);
@@ -22,12 +27,23 @@ int getpid(void);
 char* sbrk(int);
 int sleep(int);
 int uptime(void);
-int getptable(int, char*);
+int procstat(struct procstat*, int);
 int getppid(void);
 int chpr(int, int);
-int wait2(int*, int*, int*);
+int wait2(uint64*, uint64*, uint64*);
 int yield(void);
 int chtickets(int, int);
+int mkcurrency(int);
+int chcurrency(int, int);
+int setsched(int);
+int idlestat(struct idlestat*);
+int waitpid(int, int*, int, struct rusage*);
+int schedlat(struct schedlat*);
+int settrace(int);
+int traceread(struct tracering*);
+int sched_deadline(int, int, int);
+int setclass(int, int, int);
+int freemem(void);
 
 // ulib.c
 int stat(const char*, struct stat*);
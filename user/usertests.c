@@ -1962,7 +1962,7 @@ iref(char *s)
 void
 forktest(char *s)
 {
-  enum{ N = 1000 };
+  enum{ N = NPROC + 1 };
   int n, pid;
 
   for(n=0; n<N; n++){
@@ -1979,7 +1979,7 @@ forktest(char *s)
   }
 
   if(n == N){
-    printf("%s: fork claimed to work 1000 times!\n", s);
+    printf("%s: fork claimed to work %d times!\n", s, N);
     exit(1);
   }
 
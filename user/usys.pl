@@ -36,9 +36,20 @@ entry("getpid");
 entry("sbrk");
 entry("sleep");
 entry("uptime");
-entry("getptable");
+entry("procstat");
 entry("getppid");
 entry("chpr");
 entry("wait2");
 entry("yield");
 entry("chtickets");
+entry("mkcurrency");
+entry("chcurrency");
+entry("setsched");
+entry("idlestat");
+entry("waitpid");
+entry("schedlat");
+entry("settrace");
+entry("traceread");
+entry("sched_deadline");
+entry("setclass");
+entry("freemem");
@@ -0,0 +1,76 @@
+// Test waitpid().
+//
+//   waittest
+//
+// Forks a child that touches some memory, sleeps and spins,
+// and checks that waitpid() with WNOHANG returns 0 while it
+// runs, that waiting for a pid that isn't a child fails, and
+// that waiting for the child by pid returns its exit status
+// and what it used. Prints "waittest: OK" if all is well.
+
+#include "kernel/types.h"
+#include "kernel/stat.h"
+#include "kernel/rusage.h"
+#include "user/user.h"
+
+#define NPAGE 8
+
+static void
+fail(char *what)
+{
+  fprintf(2, "waittest: %s\n", what);
+  exit(1);
+}
+
+int
+main(int argc, char *argv[])
+{
+  struct rusage ru;
+  int pid, other, status, end, i;
+  char *mem;
+
+  pid = fork();
+  if(pid < 0)
+    fail("fork failed");
+  if(pid == 0){
+    if((mem = sbrk(NPAGE * 4096)) == (char*)-1)
+      exit(1);
+    for(i = 0; i < NPAGE; i++)
+      mem[i * 4096] = i;
+    sleep(2);
+    end = uptime() + 3;
+    while(uptime() < end)
+      ;
+    exit(7);
+  }
+
+  if(waitpid(pid, &status, WNOHANG, &ru) != 0)
+    fail("WNOHANG didn't return 0 for a running child");
+
+  // a child of another process isn't ours to wait for.
+  other = fork();
+  if(other < 0)
+    fail("fork failed");
+  if(other == 0)
+    exit(0);
+  if(waitpid(other + 1000, 0, 0, 0) != -1)
+    fail("waitpid of a non-child didn't fail");
+  if(waitpid(other, 0, 0, 0) != other)
+    fail("waitpid of second child failed");
+
+  if(waitpid(pid, &status, 0, &ru) != pid)
+    fail("waitpid of first child failed");
+  if(status != 7)
+    fail("wrong exit status");
+  printf("waittest: retime %lu rutime %lu stime %lu cycles\n",
+         ru.retime, ru.rutime, ru.stime);
+  printf("waittest: nvcsw %lu nivcsw %lu pgfaults %lu maxrss %lu\n",
+         ru.nvcsw, ru.nivcsw, ru.pgfaults, ru.maxrss);
+  if(ru.nvcsw == 0 || ru.pgfaults < NPAGE || ru.maxrss < NPAGE)
+    fail("implausible rusage");
+
+  if(waitpid(-1, 0, WNOHANG, 0) != -1)
+    fail("waitpid with no children didn't fail");
+  printf("waittest: OK\n");
+  exit(0);
+}